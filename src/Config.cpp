@@ -41,6 +41,8 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #define PARAM_ALERTS "alerts_enabled"
 #define PARAM_AUTHREQUIRED "auth_required"
 #define PARAM_PASSWORD "server_password"
+#define PARAM_SERIAL_FRAME_REQUEST_BUDGET "serial_frame_request_budget"
+#define PARAM_SERIAL_FRAME_TIME_BUDGET "serial_frame_time_budget_us"
 
 #define CMDLINE_WEBSOCKET_PORT "websocket_port"
 #define CMDLINE_WEBSOCKET_IPV4_ONLY "websocket_ipv4_only"
@@ -72,6 +74,10 @@ void Config::Load(json config)
 		AuthRequired = config[PARAM_AUTHREQUIRED];
 	if (config.contains(PARAM_PASSWORD) && config[PARAM_PASSWORD].is_string())
 		ServerPassword = config[PARAM_PASSWORD];
+	if (config.contains(PARAM_SERIAL_FRAME_REQUEST_BUDGET) && config[PARAM_SERIAL_FRAME_REQUEST_BUDGET].is_number_unsigned())
+		SerialFrameRequestBudget = config[PARAM_SERIAL_FRAME_REQUEST_BUDGET];
+	if (config.contains(PARAM_SERIAL_FRAME_TIME_BUDGET) && config[PARAM_SERIAL_FRAME_TIME_BUDGET].is_number_unsigned())
+		SerialFrameTimeBudget = config[PARAM_SERIAL_FRAME_TIME_BUDGET];
 
 	// Set server password and save it to the config before processing overrides,
 	// so that there is always a true configured password regardless of if
@@ -144,6 +150,8 @@ void Config::Save()
 		config[PARAM_AUTHREQUIRED] = AuthRequired.load();
 		config[PARAM_PASSWORD] = ServerPassword;
 	}
+	config[PARAM_SERIAL_FRAME_REQUEST_BUDGET] = SerialFrameRequestBudget.load();
+	config[PARAM_SERIAL_FRAME_TIME_BUDGET] = SerialFrameTimeBudget.load();
 
 	if (Utils::Json::SetJsonFileContent(configFilePath, config))
 		blog(LOG_DEBUG, "[Config::Save] Saved config.");
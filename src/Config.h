@@ -41,6 +41,8 @@ struct Config {
 	std::atomic<bool> AlertsEnabled = false;
 	std::atomic<bool> AuthRequired = true;
 	std::string ServerPassword;
+	std::atomic<uint32_t> SerialFrameRequestBudget = 0; // Max requests processed per frame by `SerialFrame` batches. 0 is unlimited
+	std::atomic<uint32_t> SerialFrameTimeBudget = 0;    // Max microseconds spent per frame by `SerialFrame` batches. 0 is unlimited
 };
 
 json MigrateGlobalConfigData();
@@ -87,7 +87,8 @@ WebSocketApi::~WebSocketApi()
 	blog_debug("[WebSocketApi::~WebSocketApi] Finished.");
 }
 
-void WebSocketApi::BroadcastEvent(uint64_t requiredIntent, const std::string &eventType, const json &eventData, uint8_t rpcVersion)
+void WebSocketApi::BroadcastEvent(uint64_t requiredIntent, const std::string &eventType, const json &eventData, uint8_t rpcVersion,
+				  const Utils::Json::RawFields &rawFields)
 {
 	if (!_obsReady)
 		return;
@@ -96,7 +97,7 @@ void WebSocketApi::BroadcastEvent(uint64_t requiredIntent, const std::string &ev
 	if (rpcVersion && rpcVersion != CURRENT_RPC_VERSION)
 		return;
 
-	std::string eventDataString = eventData.dump();
+	std::string eventDataString = rawFields.Dump(eventData);
 
 	std::shared_lock l(_mutex);
 
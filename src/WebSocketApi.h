@@ -47,7 +47,7 @@ public:
 	WebSocketApi();
 	~WebSocketApi();
 	void BroadcastEvent(uint64_t requiredIntent, const std::string &eventType, const json &eventData = nullptr,
-			    uint8_t rpcVersion = 0);
+			    uint8_t rpcVersion = 0, const Utils::Json::RawFields &rawFields = {});
 	void SetObsReady(bool ready) { _obsReady = ready; }
 	enum RequestReturnCode PerformVendorRequest(std::string vendorName, std::string requestName, obs_data_t *requestData,
 						    obs_data_t *responseData);
@@ -23,6 +23,9 @@ EventHandler::EventHandler()
 {
 	blog_debug("[EventHandler::EventHandler] Setting up...");
 
+	// Start from the current time so that ETags from a previous run of OBS never match
+	_resourceGenerationCounter = _resourceGenerationBase = os_gettime_ns();
+
 	obs_frontend_add_event_callback(OnFrontendEvent, this);
 
 	signal_handler_t *coreSignalHandler = obs_get_signal_handler();
@@ -89,6 +92,8 @@ void EventHandler::ProcessSubscriptionChange(bool type, uint64_t eventSubscripti
 			_inputShowStateChangedRef++;
 		if ((eventSubscriptions & EventSubscription::SceneItemTransformChanged) != 0)
 			_sceneItemTransformChangedRef++;
+		if ((eventSubscriptions & EventSubscription::StateDeltas) != 0)
+			_stateDeltasRef++;
 	} else {
 		if ((eventSubscriptions & EventSubscription::InputVolumeMeters) != 0) {
 			if (_inputVolumeMetersRef.fetch_sub(1) == 1)
@@ -100,16 +105,25 @@ void EventHandler::ProcessSubscriptionChange(bool type, uint64_t eventSubscripti
 			_inputShowStateChangedRef--;
 		if ((eventSubscriptions & EventSubscription::SceneItemTransformChanged) != 0)
 			_sceneItemTransformChangedRef--;
+		if ((eventSubscriptions & EventSubscription::StateDeltas) != 0)
+			_stateDeltasRef--;
 	}
 }
 
 // Function required in order to use default arguments
-void EventHandler::BroadcastEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion)
+void EventHandler::BroadcastEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion,
+				  const Utils::Json::RawFields &rawFields)
 {
+	// State must be updated even if nobody receives the event, as it invalidates cached responses
+	uint64_t stateVersion = HandleStateChange(eventType, eventData);
+
 	if (!_eventCallback)
 		return;
 
-	_eventCallback(requiredIntent, eventType, eventData, rpcVersion);
+	_eventCallback(requiredIntent, eventType, eventData, rpcVersion, rawFields);
+
+	if (stateVersion && _stateDeltasRef.load())
+		HandleStateDelta(stateVersion, eventType, eventData, rawFields);
 }
 
 // Connect source signals for Inputs, Scenes, and Transitions. Filters are automatically connected.
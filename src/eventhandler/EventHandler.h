@@ -20,6 +20,9 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <obs.hpp>
 #include <obs-frontend-api.h>
 
@@ -37,14 +40,25 @@ public:
 	void ProcessSubscriptionChange(bool type, uint64_t eventSubscriptions);
 
 	// Callback when an event fires
-	typedef std::function<void(uint64_t, std::string, json, uint8_t)>
-		EventCallback; // uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion
+	typedef std::function<void(uint64_t, std::string, json, uint8_t, const Utils::Json::RawFields &)>
+		EventCallback; // uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion, rawFields
 	inline void SetEventCallback(EventCallback cb) { _eventCallback = cb; }
 
 	// Callback when OBS becomes ready or non-ready
 	typedef std::function<void(bool)> ObsReadyCallback; // bool ready
 	inline void SetObsReadyCallback(ObsReadyCallback cb) { _obsReadyCallback = cb; }
 
+	// Scene graph state sync. The version is incremented by every event which changes the state snapshot
+	inline uint64_t GetStateVersion() { return _stateVersion; }
+	json GetStateSnapshot();
+
+	// Generation of a resource, which changes whenever the resource does. Used to create request ETags.
+	// Resource keys: `sceneList`, `inputList`, `sourceNames`, `sceneItems:<scene UUID>`, `filters:<source name>`, and
+	// `sceneItemTransforms` for transforms which are changed while nobody is subscribed to their events
+	uint64_t GetResourceGeneration(const std::string &resourceKey);
+	// For changes which do not emit an event
+	void BumpResourceGeneration(const std::string &resourceKey);
+
 private:
 	EventCallback _eventCallback;
 	ObsReadyCallback _obsReadyCallback;
@@ -59,11 +73,43 @@ private:
 	std::atomic<uint64_t> _inputActiveStateChangedRef = 0;
 	std::atomic<uint64_t> _inputShowStateChangedRef = 0;
 	std::atomic<uint64_t> _sceneItemTransformChangedRef = 0;
+	std::atomic<uint64_t> _stateDeltasRef = 0;
+
+	// Parts of the state snapshot which have changed since it was last built, so that only those are rebuilt
+	struct StateSnapshotChanges {
+		bool all = false;
+		bool allSceneItems = false;
+		std::unordered_set<std::string> sceneUuids; // Scene item lists
+		std::unordered_set<std::string> sourceNames; // Filter lists
+	};
+
+	std::atomic<uint64_t> _stateVersion = 0;
+	std::mutex _stateSnapshotMutex;
+	json _stateSnapshot;
+	uint64_t _stateSnapshotVersion = 0;
+	std::mutex _stateSnapshotChangesMutex;
+	StateSnapshotChanges _stateSnapshotChanges = {true}; // Nothing has been built yet
+	// Whether scene item transforms have been read through the state snapshot or ETags since they were last invalidated
+	std::atomic<bool> _sceneItemTransformsRead = false;
+
+	std::mutex _resourceGenerationsMutex;
+	std::unordered_map<std::string, uint64_t> _resourceGenerations;
+	uint64_t _resourceGenerationCounter;
+	uint64_t _resourceGenerationBase; // Generation of resources which have not changed since the scene collection loaded
 
 	void ConnectSourceSignals(obs_source_t *source);
 	void DisconnectSourceSignals(obs_source_t *source);
 
-	void BroadcastEvent(uint64_t requiredIntent, std::string eventType, json eventData = nullptr, uint8_t rpcVersion = 0);
+	void BroadcastEvent(uint64_t requiredIntent, std::string eventType, json eventData = nullptr, uint8_t rpcVersion = 0,
+			    const Utils::Json::RawFields &rawFields = {});
+
+	// State sync
+	uint64_t HandleStateChange(const std::string &eventType, const json &eventData);
+	uint8_t HandleResourceChange(const std::string &eventType, const json &eventData);
+	void InvalidateSceneItemTransforms();
+	static json BuildStateSnapshot(json &previousSnapshot, const StateSnapshotChanges &changes);
+	void HandleStateDelta(uint64_t stateVersion, const std::string &eventType, const json &eventData,
+			      const Utils::Json::RawFields &rawFields);
 
 	// Signal handler: frontend
 	static void OnFrontendEvent(enum obs_frontend_event event, void *private_data);
@@ -122,11 +122,13 @@ void EventHandler::HandleInputSettingsChanged(obs_source_t *source)
 {
 	OBSDataAutoRelease inputSettings = obs_source_get_settings(source);
 
+	// The settings are serialized straight into each encoding of the event
+	Utils::Json::RawFields rawFields;
 	json eventData;
 	eventData["inputName"] = obs_source_get_name(source);
 	eventData["inputUuid"] = obs_source_get_uuid(source);
-	eventData["inputSettings"] = Utils::Json::ObsDataToJson(inputSettings);
-	BroadcastEvent(EventSubscription::Inputs, "InputSettingsChanged", eventData);
+	eventData["inputSettings"] = rawFields.Add(inputSettings);
+	BroadcastEvent(EventSubscription::Inputs, "InputSettingsChanged", eventData, 0, rawFields);
 }
 
 /**
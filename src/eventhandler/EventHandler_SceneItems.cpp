@@ -50,8 +50,12 @@ void EventHandler::HandleSceneItemCreated(void *param, calldata_t *data)
 		return;
 
 	OBSCanvasAutoRelease canvas = obs_source_get_canvas(obs_scene_get_source(scene));
-	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN))
+	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN)) {
+		// Scene item lists of other canvases are still requested, so their ETags must change
+		eventHandler->HandleResourceChange("SceneItemCreated",
+						   {{"sceneUuid", obs_source_get_uuid(obs_scene_get_source(scene))}});
 		return;
+	}
 
 	json eventData;
 	eventData["sceneName"] = obs_source_get_name(obs_scene_get_source(scene));
@@ -95,8 +99,11 @@ void EventHandler::HandleSceneItemRemoved(void *param, calldata_t *data)
 		return;
 
 	OBSCanvasAutoRelease canvas = obs_source_get_canvas(obs_scene_get_source(scene));
-	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN))
+	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN)) {
+		eventHandler->HandleResourceChange("SceneItemRemoved",
+						   {{"sceneUuid", obs_source_get_uuid(obs_scene_get_source(scene))}});
 		return;
+	}
 
 	json eventData;
 	eventData["sceneName"] = obs_source_get_name(obs_scene_get_source(scene));
@@ -131,13 +138,16 @@ void EventHandler::HandleSceneItemListReindexed(void *param, calldata_t *data)
 		return;
 
 	OBSCanvasAutoRelease canvas = obs_source_get_canvas(obs_scene_get_source(scene));
-	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN))
+	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN)) {
+		eventHandler->HandleResourceChange("SceneItemListReindexed",
+						   {{"sceneUuid", obs_source_get_uuid(obs_scene_get_source(scene))}});
 		return;
+	}
 
 	json eventData;
 	eventData["sceneName"] = obs_source_get_name(obs_scene_get_source(scene));
 	eventData["sceneUuid"] = obs_source_get_uuid(obs_scene_get_source(scene));
-	eventData["sceneItems"] = Utils::Obs::ArrayHelper::GetSceneItemList(scene, true);
+	eventData["sceneItems"] = Utils::Obs::ArrayHelper::GetSceneItemList(scene, {{"sceneItemId", "sceneItemIndex"}});
 	eventHandler->BroadcastEvent(EventSubscription::SceneItems, "SceneItemListReindexed", eventData);
 }
 
@@ -172,8 +182,11 @@ void EventHandler::HandleSceneItemEnableStateChanged(void *param, calldata_t *da
 	bool sceneItemEnabled = calldata_bool(data, "visible");
 
 	OBSCanvasAutoRelease canvas = obs_source_get_canvas(obs_scene_get_source(scene));
-	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN))
+	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN)) {
+		eventHandler->HandleResourceChange("SceneItemEnableStateChanged",
+						   {{"sceneUuid", obs_source_get_uuid(obs_scene_get_source(scene))}});
 		return;
+	}
 
 	json eventData;
 	eventData["sceneName"] = obs_source_get_name(obs_scene_get_source(scene));
@@ -214,8 +227,11 @@ void EventHandler::HandleSceneItemLockStateChanged(void *param, calldata_t *data
 	bool sceneItemLocked = calldata_bool(data, "locked");
 
 	OBSCanvasAutoRelease canvas = obs_source_get_canvas(obs_scene_get_source(scene));
-	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN))
+	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN)) {
+		eventHandler->HandleResourceChange("SceneItemLockStateChanged",
+						   {{"sceneUuid", obs_source_get_uuid(obs_scene_get_source(scene))}});
 		return;
+	}
 
 	json eventData;
 	eventData["sceneName"] = obs_source_get_name(obs_scene_get_source(scene));
@@ -283,20 +299,28 @@ void EventHandler::HandleSceneItemTransformChanged(void *param, calldata_t *data
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
-	if (!eventHandler->_sceneItemTransformChangedRef.load())
-		return;
-
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
 
+	// Without subscribers, a transform change can only be observed through the state snapshot and ETags. Those only need to
+	// be invalidated once after they have been read, so any further transform changes are free until the next read.
+	if (!eventHandler->_sceneItemTransformChangedRef.load() && !eventHandler->_stateDeltasRef.load()) {
+		if (eventHandler->_sceneItemTransformsRead.exchange(false))
+			eventHandler->InvalidateSceneItemTransforms();
+		return;
+	}
+
 	obs_sceneitem_t *sceneItem = GetCalldataPointer<obs_sceneitem_t>(data, "item");
 	if (!sceneItem)
 		return;
 
 	OBSCanvasAutoRelease canvas = obs_source_get_canvas(obs_scene_get_source(scene));
-	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN))
+	if (!canvas || !(obs_canvas_get_flags(canvas) & MAIN)) {
+		eventHandler->HandleResourceChange("SceneItemTransformChanged",
+						   {{"sceneUuid", obs_source_get_uuid(obs_scene_get_source(scene))}});
 		return;
+	}
 
 	json eventData;
 	eventData["sceneName"] = obs_source_get_name(obs_scene_get_source(scene));
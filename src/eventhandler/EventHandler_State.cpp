@@ -0,0 +1,329 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "EventHandler.h"
+
+// Number of times a snapshot is rebuilt if the state changes while it is being built
+#define STATE_SNAPSHOT_ATTEMPTS 3
+
+// Resources which are changed by an event
+enum StateChange : uint8_t {
+	SnapshotChange = (1 << 0), // Anything contained in the state snapshot
+	SceneListChange = (1 << 1),
+	InputListChange = (1 << 2),
+	SourceNameChange = (1 << 3),
+	SceneItemsChange = (1 << 4),
+	FiltersChange = (1 << 5),
+	ResetChange = (1 << 6), // All resources
+	RemoveChange = (1 << 7), // Resources of the removed scene or input
+};
+
+static const std::unordered_map<std::string, uint8_t> stateEvents = {
+	{"CurrentSceneCollectionChanged", SnapshotChange | ResetChange},
+	{"SceneCreated", SnapshotChange | SceneListChange},
+	{"SceneRemoved", SnapshotChange | SceneListChange | RemoveChange},
+	{"SceneNameChanged", SnapshotChange | SceneListChange | SourceNameChange},
+	{"SceneListChanged", SnapshotChange | SceneListChange},
+	{"CurrentProgramSceneChanged", SceneListChange},
+	{"CurrentPreviewSceneChanged", SceneListChange},
+	{"StudioModeStateChanged", SceneListChange},
+	{"CanvasCreated", SceneListChange},
+	{"CanvasRemoved", SceneListChange},
+	{"CanvasNameChanged", SceneListChange},
+	{"InputCreated", SnapshotChange | InputListChange},
+	{"InputRemoved", SnapshotChange | InputListChange | RemoveChange},
+	{"InputNameChanged", SnapshotChange | InputListChange | SourceNameChange},
+	{"SceneItemCreated", SnapshotChange | SceneItemsChange},
+	{"SceneItemRemoved", SnapshotChange | SceneItemsChange},
+	{"SceneItemListReindexed", SnapshotChange | SceneItemsChange},
+	{"SceneItemEnableStateChanged", SnapshotChange | SceneItemsChange},
+	{"SceneItemLockStateChanged", SnapshotChange | SceneItemsChange},
+	{"SceneItemTransformChanged", SnapshotChange | SceneItemsChange},
+	{"SourceFilterCreated", SnapshotChange | FiltersChange},
+	{"SourceFilterRemoved", SnapshotChange | FiltersChange},
+	{"SourceFilterNameChanged", SnapshotChange | FiltersChange},
+	{"SourceFilterSettingsChanged", SnapshotChange | FiltersChange},
+	{"SourceFilterEnableStateChanged", SnapshotChange | FiltersChange},
+	{"SourceFilterListReindexed", SnapshotChange | FiltersChange},
+};
+
+static std::vector<json> GetStateSceneItemList(obs_scene_t *scene)
+{
+	std::vector<json> sceneItems = Utils::Obs::ArrayHelper::GetSceneItemList(scene);
+	for (auto &sceneItem : sceneItems) {
+		if (!sceneItem["isGroup"].is_boolean() || !sceneItem["isGroup"].get<bool>())
+			continue;
+
+		obs_sceneitem_t *groupItem = obs_scene_find_sceneitem_by_id(scene, sceneItem["sceneItemId"]);
+		if (!groupItem)
+			continue;
+
+		obs_scene_t *groupScene = obs_sceneitem_group_get_scene(groupItem);
+		if (groupScene)
+			sceneItem["groupSceneItems"] = Utils::Obs::ArrayHelper::GetSceneItemList(groupScene);
+	}
+
+	return sceneItems;
+}
+
+// Items of groups are listed with the group, but their events are for the group's scene
+static bool HasChangedGroup(const json &sceneItems, const std::unordered_set<std::string> &sceneUuids)
+{
+	for (auto &sceneItem : sceneItems)
+		if (sceneItem.contains("groupSceneItems") && sceneUuids.count(sceneItem["sourceUuid"].get<std::string>()))
+			return true;
+
+	return false;
+}
+
+// The scene and input lists are always rebuilt, as they are cheap. The scene item and filter lists which have not changed are
+// moved over from the previous snapshot instead.
+json EventHandler::BuildStateSnapshot(json &previousSnapshot, const StateSnapshotChanges &changes)
+{
+	std::unordered_map<std::string, json *> previousScenes;
+	std::unordered_map<std::string, json *> previousInputs;
+	if (!changes.all && previousSnapshot.is_object()) {
+		for (auto &sceneJson : previousSnapshot["scenes"])
+			previousScenes[sceneJson["sceneUuid"].get<std::string>()] = &sceneJson;
+		for (auto &inputJson : previousSnapshot["inputs"])
+			previousInputs[inputJson["inputUuid"].get<std::string>()] = &inputJson;
+	}
+
+	json ret;
+
+	std::vector<json> scenes = Utils::Obs::ArrayHelper::GetSceneList();
+	for (auto &sceneJson : scenes) {
+		std::string sceneUuid = sceneJson["sceneUuid"];
+		auto previous = previousScenes.find(sceneUuid);
+		json *previousScene = previous != previousScenes.end() ? previous->second : nullptr;
+
+		bool sceneItemsChanged = !previousScene || !previousScene->contains("sceneItems") || changes.allSceneItems ||
+					 changes.sceneUuids.count(sceneUuid) ||
+					 HasChangedGroup((*previousScene)["sceneItems"], changes.sceneUuids);
+		bool sceneFiltersChanged = !previousScene || !previousScene->contains("sceneFilters") ||
+					   changes.sourceNames.count(sceneJson["sceneName"].get<std::string>());
+
+		if (!sceneItemsChanged)
+			sceneJson["sceneItems"] = std::move((*previousScene)["sceneItems"]);
+		if (!sceneFiltersChanged)
+			sceneJson["sceneFilters"] = std::move((*previousScene)["sceneFilters"]);
+		if (!sceneItemsChanged && !sceneFiltersChanged)
+			continue;
+
+		OBSSourceAutoRelease sceneSource = obs_get_source_by_uuid(sceneUuid.c_str());
+		obs_scene_t *scene = obs_scene_from_source(sceneSource);
+		if (!scene)
+			continue;
+
+		if (sceneItemsChanged)
+			sceneJson["sceneItems"] = GetStateSceneItemList(scene);
+		if (sceneFiltersChanged)
+			sceneJson["sceneFilters"] = Utils::Obs::ArrayHelper::GetSourceFilterList(sceneSource);
+	}
+	ret["scenes"] = scenes;
+
+	std::vector<json> inputs = Utils::Obs::ArrayHelper::GetInputList();
+	for (auto &inputJson : inputs) {
+		std::string inputUuid = inputJson["inputUuid"];
+		auto previous = previousInputs.find(inputUuid);
+		if (previous != previousInputs.end() && previous->second->contains("inputFilters") &&
+		    !changes.sourceNames.count(inputJson["inputName"].get<std::string>())) {
+			inputJson["inputFilters"] = std::move((*previous->second)["inputFilters"]);
+			continue;
+		}
+
+		OBSSourceAutoRelease input = obs_get_source_by_uuid(inputUuid.c_str());
+		if (!input)
+			continue;
+
+		inputJson["inputFilters"] = Utils::Obs::ArrayHelper::GetSourceFilterList(input);
+	}
+	ret["inputs"] = inputs;
+
+	return ret;
+}
+
+// Returns the new state version, or 0 if the event does not change the state snapshot
+uint64_t EventHandler::HandleStateChange(const std::string &eventType, const json &eventData)
+{
+	uint8_t changes = HandleResourceChange(eventType, eventData);
+	if (!(changes & SnapshotChange))
+		return 0;
+
+	// Recorded before the version is incremented, so that a snapshot built for the new version includes the change
+	{
+		std::lock_guard<std::mutex> lock(_stateSnapshotChangesMutex);
+		// Renames change the scene items of every scene, and which filter lists the changes of a source name are for
+		if (changes & (ResetChange | SourceNameChange)) {
+			_stateSnapshotChanges.all = true;
+			_stateSnapshotChanges.sceneUuids.clear();
+			_stateSnapshotChanges.sourceNames.clear();
+		} else if (!_stateSnapshotChanges.all) {
+			if (changes & SceneItemsChange)
+				_stateSnapshotChanges.sceneUuids.insert(eventData["sceneUuid"].get<std::string>());
+			if (changes & FiltersChange)
+				_stateSnapshotChanges.sourceNames.insert(eventData["sourceName"].get<std::string>());
+		}
+	}
+
+	return ++_stateVersion;
+}
+
+// Without subscribers, transform changes are not tracked per scene, see `HandleSceneItemTransformChanged`. Instead the
+// transforms of every scene are invalidated at once.
+void EventHandler::InvalidateSceneItemTransforms()
+{
+	BumpResourceGeneration("sceneItemTransforms");
+
+	{
+		std::lock_guard<std::mutex> lock(_stateSnapshotChangesMutex);
+		_stateSnapshotChanges.allSceneItems = true;
+	}
+
+	++_stateVersion;
+}
+
+// Bumps the generations of the resources changed by an event, and returns the changes made by it.
+// Also used for changes which are not broadcast as events, like scenes of non-main canvases.
+uint8_t EventHandler::HandleResourceChange(const std::string &eventType, const json &eventData)
+{
+	auto it = stateEvents.find(eventType);
+	if (it == stateEvents.end())
+		return 0;
+
+	uint8_t changes = it->second;
+
+	{
+		std::lock_guard<std::mutex> lock(_resourceGenerationsMutex);
+		uint64_t generation = ++_resourceGenerationCounter;
+
+		if (changes & ResetChange) {
+			_resourceGenerations.clear();
+			_resourceGenerationBase = generation;
+		}
+		if (changes & SceneListChange)
+			_resourceGenerations["sceneList"] = generation;
+		if (changes & InputListChange)
+			_resourceGenerations["inputList"] = generation;
+		if (changes & SourceNameChange) {
+			// Scene item lists contain source names, and filters are looked up by source name
+			_resourceGenerations["sourceNames"] = generation;
+			for (auto key : {"oldSceneName", "sceneName", "oldInputName", "inputName"})
+				if (eventData.contains(key))
+					_resourceGenerations["filters:" + eventData[key].get<std::string>()] = generation;
+		}
+		if ((changes & SceneItemsChange) && eventData.contains("sceneUuid"))
+			_resourceGenerations["sceneItems:" + eventData["sceneUuid"].get<std::string>()] = generation;
+		if ((changes & FiltersChange) && eventData.contains("sourceName"))
+			_resourceGenerations["filters:" + eventData["sourceName"].get<std::string>()] = generation;
+		if (changes & RemoveChange) {
+			// Keys are dropped so that they do not pile up. They fall back to the base generation, which is raised
+			// so that no generation ever goes back to an earlier value, which could match an old ETag
+			if (eventData.contains("sceneUuid"))
+				_resourceGenerations.erase("sceneItems:" + eventData["sceneUuid"].get<std::string>());
+			for (auto key : {"sceneName", "inputName"})
+				if (eventData.contains(key))
+					_resourceGenerations.erase("filters:" + eventData[key].get<std::string>());
+			_resourceGenerationBase = generation;
+		}
+	}
+
+	return changes;
+}
+
+uint64_t EventHandler::GetResourceGeneration(const std::string &resourceKey)
+{
+	if (resourceKey == "sceneItemTransforms")
+		_sceneItemTransformsRead = true;
+
+	std::lock_guard<std::mutex> lock(_resourceGenerationsMutex);
+	auto it = _resourceGenerations.find(resourceKey);
+	if (it == _resourceGenerations.end())
+		return _resourceGenerationBase;
+
+	return it->second;
+}
+
+void EventHandler::BumpResourceGeneration(const std::string &resourceKey)
+{
+	std::lock_guard<std::mutex> lock(_resourceGenerationsMutex);
+	_resourceGenerations[resourceKey] = ++_resourceGenerationCounter;
+}
+
+// The snapshot is shared by all clients, and only rebuilt once the state has changed
+json EventHandler::GetStateSnapshot()
+{
+	std::lock_guard<std::mutex> lock(_stateSnapshotMutex);
+
+	// Set before the snapshot is checked, so that any transform change after this invalidates it
+	_sceneItemTransformsRead = true;
+
+	if (!_stateSnapshot.is_null() && _stateSnapshotVersion == _stateVersion)
+		return _stateSnapshot;
+
+	// Tagging the snapshot with the version from before it was built means that at worst, a client re-applies a delta.
+	// Each attempt only rebuilds what has changed since the previous one.
+	uint64_t stateVersion = 0;
+	for (size_t i = 0; i < STATE_SNAPSHOT_ATTEMPTS; i++) {
+		stateVersion = _stateVersion;
+
+		StateSnapshotChanges changes;
+		{
+			std::lock_guard<std::mutex> lock(_stateSnapshotChangesMutex);
+			std::swap(changes, _stateSnapshotChanges);
+		}
+
+		_stateSnapshot = BuildStateSnapshot(_stateSnapshot, changes);
+		if (_stateVersion == stateVersion)
+			break;
+	}
+
+	_stateSnapshot["stateVersion"] = stateVersion;
+	_stateSnapshotVersion = stateVersion;
+
+	return _stateSnapshot;
+}
+
+/**
+ * The scene graph state has changed.
+ *
+ * Sent alongside every event which changes the state returned by `GetStateSnapshot`, tagged with the new state version.
+ * Events may be received out of order, so `stateVersion` should be used to order them.
+ *
+ * @dataField stateVersion | Number | State version after this change
+ * @dataField eventType    | String | Type of the event which caused the change
+ * @dataField eventData    | Object | Data of the event which caused the change
+ *
+ * @eventType StateDelta
+ * @eventSubscription StateDeltas
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api events
+ * @category general
+ */
+void EventHandler::HandleStateDelta(uint64_t stateVersion, const std::string &eventType, const json &eventData,
+				    const Utils::Json::RawFields &rawFields)
+{
+	json deltaData;
+	deltaData["stateVersion"] = stateVersion;
+	deltaData["eventType"] = eventType;
+	deltaData["eventData"] = eventData;
+	_eventCallback(EventSubscription::StateDeltas, "StateDelta", deltaData, 0, rawFields);
+}
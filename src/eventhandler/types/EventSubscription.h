@@ -220,5 +220,27 @@ namespace EventSubscription {
 		* @api enums
 		*/
 		SceneItemTransformChanged = (1 << 19),
+		/**
+		* Subscription value to receive the `StateDelta` high-volume event.
+		*
+		* @enumIdentifier StateDeltas
+		* @enumValue (1 << 20)
+		* @enumType EventSubscription
+		* @rpcVersion -1
+		* @initialVersion 5.8.0
+		* @api enums
+		*/
+		StateDeltas = (1 << 20),
+		/**
+		* Subscription value to receive the `PersistentDataChanged` high-volume event.
+		*
+		* @enumIdentifier PersistentDataChanged
+		* @enumValue (1 << 21)
+		* @enumType EventSubscription
+		* @rpcVersion -1
+		* @initialVersion 5.8.0
+		* @api enums
+		*/
+		PersistentDataChanged = (1 << 21),
 	};
 }
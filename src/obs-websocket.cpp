@@ -27,7 +27,21 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "WebSocketApi.h"
 #include "websocketserver/WebSocketServer.h"
 #include "eventhandler/EventHandler.h"
+#include "requesthandler/AnimationManager.h"
+#include "requesthandler/PersistentDataStore.h"
+#include "requesthandler/RequestScheduler.h"
+#include "requesthandler/ScreenshotRenderer.h"
+#include "requesthandler/ScreenshotSaver.h"
+#include "requesthandler/ScreenshotStreamManager.h"
 #include "forms/SettingsDialog.h"
+#ifdef PLUGIN_TESTS
+#include <QDir>
+#include <QFile>
+#include <util/bmem.h>
+#include "requesthandler/RequestHandler.h"
+#include "requesthandler/RequestBatchHandler.h"
+#include "utils/Image.h"
+#endif
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-websocket", "en-US")
@@ -46,10 +60,22 @@ ConfigPtr _config;
 EventHandlerPtr _eventHandler;
 WebSocketApiPtr _webSocketApi;
 WebSocketServerPtr _webSocketServer;
+AnimationManagerPtr _animationManager;
+RequestSchedulerPtr _requestScheduler;
+PersistentDataStorePtr _persistentDataStore;
+ScreenshotRendererPtr _screenshotRenderer;
+ScreenshotSaverPtr _screenshotSaver;
+ScreenshotStreamManagerPtr _screenshotStreamManager;
 SettingsDialog *_settingsDialog = nullptr;
 
 void OnWebSocketApiVendorEvent(std::string vendorName, std::string eventType, obs_data_t *obsEventData);
-void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion);
+void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion,
+	     const Utils::Json::RawFields &rawFields = {});
+void OnAnimationEnded(json eventData);
+void OnScheduledRequestBatchExecuted(SessionPtr session, json eventData);
+void OnSourceScreenshotStreamFrame(SessionPtr session, json eventData);
+void OnSourceScreenshotSaved(SessionPtr session, json eventData);
+void OnPersistentDataChanged(json eventData);
 void OnObsReady(bool ready);
 
 bool obs_module_load(void)
@@ -73,6 +99,10 @@ bool obs_module_load(void)
 	_config = std::make_shared<Config>();
 	_config->Load(migratedConfig);
 
+	// Initialize the persistent data store
+	_persistentDataStore = std::make_shared<PersistentDataStore>();
+	_persistentDataStore->SetDataChangedCallback(OnPersistentDataChanged);
+
 	// Initialize the event handler
 	_eventHandler = std::make_shared<EventHandler>();
 	_eventHandler->SetEventCallback(OnEvent);
@@ -87,6 +117,25 @@ bool obs_module_load(void)
 	_webSocketServer->SetClientSubscriptionCallback(std::bind(&EventHandler::ProcessSubscriptionChange, _eventHandler.get(),
 								  std::placeholders::_1, std::placeholders::_2));
 
+	// Initialize the animation manager
+	_animationManager = std::make_shared<AnimationManager>();
+	_animationManager->SetAnimationEndedCallback(OnAnimationEnded);
+
+	// Initialize the request scheduler
+	_requestScheduler = std::make_shared<RequestScheduler>();
+	_requestScheduler->SetBatchExecutedCallback(OnScheduledRequestBatchExecuted);
+
+	// Initialize the screenshot renderer
+	_screenshotRenderer = std::make_shared<ScreenshotRenderer>();
+
+	// Initialize the screenshot saver
+	_screenshotSaver = std::make_shared<ScreenshotSaver>();
+	_screenshotSaver->SetSaveCompletedCallback(OnSourceScreenshotSaved);
+
+	// Initialize the screenshot stream manager
+	_screenshotStreamManager = std::make_shared<ScreenshotStreamManager>();
+	_screenshotStreamManager->SetFrameCallback(OnSourceScreenshotStreamFrame);
+
 	// Initialize the settings dialog
 	obs_frontend_push_ui_translation(obs_module_get_string);
 	QMainWindow *mainWindow = static_cast<QMainWindow *>(obs_frontend_get_main_window());
@@ -106,6 +155,13 @@ bool obs_module_load(void)
 void test_call_request();
 void test_register_event_callback();
 void test_register_vendor();
+void test_request_batch_template();
+void test_request_batch_payload();
+void test_input_audio_states();
+void test_source_screenshot();
+void test_persistent_data();
+void test_obs_data_conversion();
+void test_obs_data_serialization();
 #endif
 
 void obs_module_post_load(void)
@@ -114,6 +170,13 @@ void obs_module_post_load(void)
 	test_call_request();
 	test_register_event_callback();
 	test_register_vendor();
+	test_request_batch_template();
+	test_request_batch_payload();
+	test_input_audio_states();
+	test_source_screenshot();
+	test_persistent_data();
+	test_obs_data_conversion();
+	test_obs_data_serialization();
 #endif
 
 	// Server will accept clients, but requests and events will not be served until FINISHED_LOADING occurs
@@ -127,12 +190,27 @@ void obs_module_unload(void)
 {
 	blog(LOG_INFO, "[obs_module_unload] Shutting down...");
 
-	// Shutdown the WebSocket server if it is running
+	// Shutdown the WebSocket server if it is running. This waits for requests in progress, which may be using any of the
+	// components below, so it is done first
 	if (_webSocketServer->IsListening()) {
 		blog_debug("[obs_module_unload] WebSocket server is running. Stopping...");
 		_webSocketServer->Stop();
 	}
 
+	// Stop running animations and scheduled batches before the components they report to are released.
+	// Callbacks are not reset, as the graphics thread may be calling them until the tick callbacks are removed.
+	_animationManager = nullptr;
+	_requestScheduler = nullptr;
+
+	// Release the screenshot stream manager, then the renderer, failing any screenshots still in progress
+	_screenshotStreamManager->SetFrameCallback(nullptr);
+	_screenshotStreamManager = nullptr;
+	_screenshotRenderer = nullptr;
+
+	// Release the screenshot saver, which finishes the saves that were already accepted. Their sessions have been
+	// disconnected by stopping the server, so no events are sent for them
+	_screenshotSaver = nullptr;
+
 	// Release the WebSocket server
 	_webSocketServer->SetClientSubscriptionCallback(nullptr);
 	_webSocketServer = nullptr;
@@ -140,6 +218,10 @@ void obs_module_unload(void)
 	// Release the plugin/script api
 	_webSocketApi = nullptr;
 
+	// Release the persistent data store, writing any changes which are still pending
+	_persistentDataStore->SetDataChangedCallback(nullptr);
+	_persistentDataStore = nullptr;
+
 	// Release the event handler
 	_eventHandler->SetObsReadyCallback(nullptr);
 	_eventHandler->SetEventCallback(nullptr);
@@ -179,6 +261,36 @@ WebSocketServerPtr GetWebSocketServer()
 	return _webSocketServer;
 }
 
+AnimationManagerPtr GetAnimationManager()
+{
+	return _animationManager;
+}
+
+RequestSchedulerPtr GetRequestScheduler()
+{
+	return _requestScheduler;
+}
+
+PersistentDataStorePtr GetPersistentDataStore()
+{
+	return _persistentDataStore;
+}
+
+ScreenshotRendererPtr GetScreenshotRenderer()
+{
+	return _screenshotRenderer;
+}
+
+ScreenshotSaverPtr GetScreenshotSaver()
+{
+	return _screenshotSaver;
+}
+
+ScreenshotStreamManagerPtr GetScreenshotStreamManager()
+{
+	return _screenshotStreamManager;
+}
+
 bool IsDebugEnabled()
 {
 	return !_config || _config->DebugEnabled;
@@ -215,12 +327,142 @@ void OnWebSocketApiVendorEvent(std::string vendorName, std::string eventType, ob
 }
 
 // Sent from: EventHandler
-void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion)
+void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion,
+	     const Utils::Json::RawFields &rawFields)
 {
 	if (_webSocketServer)
-		_webSocketServer->BroadcastEvent(requiredIntent, eventType, eventData, rpcVersion);
+		_webSocketServer->BroadcastEvent(requiredIntent, eventType, eventData, rpcVersion, rawFields);
 	if (_webSocketApi)
-		_webSocketApi->BroadcastEvent(requiredIntent, eventType, eventData, rpcVersion);
+		_webSocketApi->BroadcastEvent(requiredIntent, eventType, eventData, rpcVersion, rawFields);
+}
+
+/**
+ * An animation started by a request has completed or was cancelled.
+ *
+ * Also contains the fields which identify the target of the animation, like `sceneUuid` and `sceneItemId` for `StartSceneItemAnimation`.
+ *
+ * @dataField animationId   | Number  | ID of the animation
+ * @dataField animationType | String  | Type of the request which started the animation
+ * @dataField cancelled     | Boolean | Whether the animation was stopped before it completed, by `StopAnimation`, a newer animation of the same target, or its target being removed
+ *
+ * @eventType AnimationEnded
+ * @eventSubscription General
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api events
+ * @category general
+ */
+// Sent from: AnimationManager
+void OnAnimationEnded(json eventData)
+{
+	OnEvent(EventSubscription::General, "AnimationEnded", eventData, 0);
+}
+
+/**
+ * A request batch scheduled with `ScheduleRequestBatch` has been executed.
+ *
+ * Only sent to the session which scheduled the batch, regardless of its event subscriptions.
+ *
+ * @dataField scheduleId     | Number        | ID of the scheduled batch
+ * @dataField frame          | Number        | Frame the batch was executed on, counted like `GetFrameClock`
+ * @dataField frameTimestamp | Number        | Timestamp of the frame the batch was executed on, in nanoseconds
+ * @dataField results        | Array<Object> | Array of request results, in the same format as the `results` of a `RequestBatchResponse`
+ *
+ * @eventType ScheduledRequestBatchExecuted
+ * @eventSubscription None
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api events
+ * @category general
+ */
+// Sent from: RequestScheduler
+void OnScheduledRequestBatchExecuted(SessionPtr session, json eventData)
+{
+	// Batches scheduled through the plugin API have no session to send their results to
+	if (session && _webSocketServer)
+		_webSocketServer->SendEvent(session, "ScheduledRequestBatchExecuted", std::move(eventData));
+}
+
+/**
+ * A screenshot of a stream started with `StartSourceScreenshotStream`.
+ *
+ * Only sent to the session which started the stream, regardless of its event subscriptions. One event is sent per source and interval.
+ *
+ * @dataField streamId    | Number | ID of the stream
+ * @dataField sourceName  | String | Name of the source
+ * @dataField sourceUuid  | String | UUID of the source
+ * @dataField imageData   | String | Base64-encoded screenshot, or the encoded image as binary data if the stream uses `imageBinary`
+ * @dataField imageWidth  | Number | Width of the screenshot
+ * @dataField imageHeight | Number | Height of the screenshot
+ *
+ * @eventType SourceScreenshotStreamFrame
+ * @eventSubscription None
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api events
+ * @category sources
+ */
+// Sent from: ScreenshotStreamManager
+void OnSourceScreenshotStreamFrame(SessionPtr session, json eventData)
+{
+	if (_webSocketServer)
+		_webSocketServer->SendEvent(session, "SourceScreenshotStreamFrame", std::move(eventData));
+}
+
+/**
+ * A screenshot saved with `SaveSourceScreenshot` in `async` mode has been written, or has failed to be.
+ *
+ * Only sent to the session which saved the screenshot, regardless of its event subscriptions.
+ *
+ * @dataField jobId         | Number  | ID of the save, as returned by `SaveSourceScreenshot`
+ * @dataField imageFilePath | String  | Absolute path of the screenshot file
+ * @dataField success       | Boolean | Whether the screenshot was encoded and written
+ * @dataField error         | String  | Reason for the failure. Only included if `success` is false
+ * @dataField encodeTime    | Number  | Time spent encoding the screenshot, in milliseconds
+ * @dataField writeTime     | Number  | Time spent writing the screenshot file, in milliseconds
+ *
+ * @eventType SourceScreenshotSaved
+ * @eventSubscription None
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api events
+ * @category sources
+ */
+// Sent from: ScreenshotSaver
+void OnSourceScreenshotSaved(SessionPtr session, json eventData)
+{
+	// Screenshots saved through the plugin API have no session to send the event to
+	if (session && _webSocketServer)
+		_webSocketServer->SendEvent(session, "SourceScreenshotSaved", std::move(eventData));
+}
+
+/**
+ * The value of a persistent data slot has changed, through `SetPersistentData`, `CompareAndSetPersistentData` or `IncrementPersistentData`.
+ *
+ * Events may be received out of order, so `sequence` should be used to order the changes of a realm.
+ * Setting a slot to the value it already has does not send this event.
+ *
+ * @dataField realm     | String | The data realm of the slot
+ * @dataField slotName  | String | The name of the slot
+ * @dataField slotValue | Any    | The new value of the slot
+ * @dataField sequence  | Number | Number of the change within its realm, which increases by 1 with every change
+ *
+ * @eventType PersistentDataChanged
+ * @eventSubscription PersistentDataChanged
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api events
+ * @category config
+ */
+// Sent from: PersistentDataStore
+void OnPersistentDataChanged(json eventData)
+{
+	OnEvent(EventSubscription::PersistentDataChanged, "PersistentDataChanged", eventData, 0);
 }
 
 // Sent from: EventHandler
@@ -301,4 +543,456 @@ void test_register_vendor()
 
 	blog(LOG_INFO, "[test_register_vendor] Test done.");
 }
+
+// Mirrors the work done by `WebSocketServer::ProcessMessage` for a `RequestBatch` message. Returns the total time taken.
+// Passing `moveRequestData = false` copies each request's data out of the payload, as batches were previously handled
+uint64_t time_request_batch(const std::string &batchPayloadString,
+			    RequestBatchExecutionType::RequestBatchExecutionType executionType, size_t iterations,
+			    bool moveRequestData = true)
+{
+	QThreadPool *threadPool = GetWebSocketServer()->GetThreadPool();
+
+	uint64_t startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++) {
+		json payload = json::parse(batchPayloadString);
+		json &requestsJson = payload["requests"];
+		std::vector<RequestBatchRequest> requests;
+		requests.reserve(requestsJson.size());
+		for (auto &requestJson : requestsJson) {
+			json &requestDataJson = requestJson["requestData"];
+			json requestData = moveRequestData ? std::move(requestDataJson) : json(requestDataJson);
+			requests.emplace_back(requestJson["requestType"].get_ref<const std::string &>(), std::move(requestData),
+					      executionType);
+		}
+		json variables;
+		RequestBatchHandler::ProcessRequestBatch(*threadPool, nullptr, executionType, requests, variables, false);
+	}
+
+	return os_gettime_ns() - startTime;
+}
+
+void test_request_batch_template()
+{
+	blog(LOG_INFO, "[test_request_batch_template] Comparing request batch templates against full request batches...");
+
+	const size_t requestCount = 30;
+	const size_t iterations = 100;
+
+	json batchRequests = json::array();
+	for (size_t i = 0; i < requestCount; i++)
+		batchRequests.push_back({{"requestType", "GetVersion"}, {"requestId", std::to_string(i)}});
+
+	json batchPayload = {{"requestId", "test"}, {"requests", batchRequests}};
+	std::string batchPayloadString = batchPayload.dump();
+
+	RequestHandler requestHandler;
+	RequestResult createResult = requestHandler.ProcessRequest(Request(
+		"CreateRequestBatchTemplate", {{"templateName", "test_request_batch_template"}, {"requests", batchRequests}}));
+	if (createResult.StatusCode != RequestStatus::Success) {
+		blog(LOG_ERROR, "[test_request_batch_template] Failed to create template: %s", createResult.Comment.c_str());
+		return;
+	}
+
+	uint64_t batchTime = time_request_batch(batchPayloadString, RequestBatchExecutionType::SerialRealtime, iterations);
+
+	std::string callPayloadString = json({{"templateName", "test_request_batch_template"}}).dump();
+	uint64_t startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++)
+		requestHandler.ProcessRequest(Request("CallRequestBatchTemplate", json::parse(callPayloadString)));
+	uint64_t templateTime = os_gettime_ns() - startTime;
+
+	requestHandler.ProcessRequest(Request("RemoveRequestBatchTemplate", {{"templateName", "test_request_batch_template"}}));
+
+	blog(LOG_INFO, "[test_request_batch_template] Full batch: %.3f us/call | Template: %.3f us/call",
+	     (double)batchTime / iterations / 1000.0, (double)templateTime / iterations / 1000.0);
+
+	blog(LOG_INFO, "[test_request_batch_template] Test done.");
+}
+
+void test_request_batch_payload()
+{
+	blog(LOG_INFO, "[test_request_batch_payload] Comparing copied and moved request batch payloads...");
+
+	const size_t requestCount = 20;
+	const size_t iterations = 50;
+
+	// Each request carries a large `requestData`, like a big `SetInputSettings` would
+	json requestData = {{"items", json::array()}};
+	for (size_t i = 0; i < 2000; i++)
+		requestData["items"].push_back({{"name", "item" + std::to_string(i)}, {"value", i}});
+
+	json batchRequests = json::array();
+	for (size_t i = 0; i < requestCount; i++)
+		batchRequests.push_back(
+			{{"requestType", "GetVersion"}, {"requestId", std::to_string(i)}, {"requestData", requestData}});
+	std::string batchPayloadString = json({{"requestId", "test"}, {"requests", batchRequests}}).dump();
+
+	uint64_t copyTime = time_request_batch(batchPayloadString, RequestBatchExecutionType::SerialFrame, iterations, false);
+	uint64_t moveTime = time_request_batch(batchPayloadString, RequestBatchExecutionType::SerialFrame, iterations);
+
+	blog(LOG_INFO, "[test_request_batch_payload] Copied: %.3f ms/batch | Moved: %.3f ms/batch",
+	     (double)copyTime / iterations / 1000000.0, (double)moveTime / iterations / 1000000.0);
+
+	blog(LOG_INFO, "[test_request_batch_payload] Test done.");
+}
+
+void test_input_audio_states()
+{
+	blog(LOG_INFO, "[test_input_audio_states] Comparing GetInputAudioStates against an equivalent request batch...");
+
+	const size_t iterations = 100;
+
+	RequestHandler requestHandler;
+	RequestResult statesResult = requestHandler.ProcessRequest(Request("GetInputAudioStates"));
+	if (statesResult.StatusCode != RequestStatus::Success) {
+		blog(LOG_ERROR, "[test_input_audio_states] GetInputAudioStates failed: %s", statesResult.Comment.c_str());
+		return;
+	}
+
+	json inputUuids = json::array();
+	for (auto &input : statesResult.ResponseData["inputs"])
+		inputUuids.push_back(input["inputUuid"]);
+
+	if (inputUuids.empty()) {
+		blog(LOG_INFO, "[test_input_audio_states] No audio inputs exist, skipping.");
+		return;
+	}
+
+	// What a mixer view previously had to send to get the same information
+	json batchRequests = json::array();
+	for (auto &inputUuid : inputUuids)
+		for (auto requestType : {"GetInputMute", "GetInputVolume", "GetInputAudioBalance", "GetInputAudioSyncOffset",
+					 "GetInputAudioMonitorType", "GetInputAudioTracks"})
+			batchRequests.push_back({{"requestType", requestType}, {"requestData", {{"inputUuid", inputUuid}}}});
+	std::string batchPayloadString = json({{"requestId", "test"}, {"requests", batchRequests}}).dump();
+
+	uint64_t batchTime = time_request_batch(batchPayloadString, RequestBatchExecutionType::SerialRealtime, iterations);
+
+	std::string statesPayloadString = json({{"inputUuids", inputUuids}}).dump();
+	uint64_t startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++)
+		requestHandler.ProcessRequest(Request("GetInputAudioStates", json::parse(statesPayloadString)));
+	uint64_t statesTime = os_gettime_ns() - startTime;
+
+	blog(LOG_INFO, "[test_input_audio_states] %zu inputs | Request batch: %.3f us/call | GetInputAudioStates: %.3f us/call",
+	     inputUuids.size(), (double)batchTime / iterations / 1000.0, (double)statesTime / iterations / 1000.0);
+
+	blog(LOG_INFO, "[test_input_audio_states] Test done.");
+}
+
+void test_source_screenshot()
+{
+	blog(LOG_INFO, "[test_source_screenshot] Taking screenshots of a color source...");
+
+	const size_t iterations = 30;
+
+	OBSDataAutoRelease settings = obs_data_create();
+	obs_data_set_int(settings, "color", 0xFF0000FF); // ABGR, opaque red
+	obs_data_set_int(settings, "width", 320);
+	obs_data_set_int(settings, "height", 180);
+	OBSSourceAutoRelease source = obs_source_create_private("color_source_v3", "obs-websocket screenshot test", settings);
+	if (!source) {
+		blog(LOG_ERROR, "[test_source_screenshot] Failed to create color source.");
+		return;
+	}
+
+	QImage image;
+	if (!GetScreenshotRenderer()->Render(source, 320, 180, image)) {
+		blog(LOG_ERROR, "[test_source_screenshot] Failed to take screenshot.");
+		return;
+	}
+
+	QColor pixel = image.pixelColor(160, 90);
+	if (pixel.red() != 255 || pixel.green() != 0 || pixel.blue() != 0 || pixel.alpha() != 255)
+		blog(LOG_ERROR, "[test_source_screenshot] Unexpected pixel color: %d, %d, %d, %d", pixel.red(), pixel.green(),
+		     pixel.blue(), pixel.alpha());
+
+	// Same resolution, so every capture after the first reuses the pooled texrender and stage surface
+	uint64_t startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++)
+		GetScreenshotRenderer()->Render(source, 320, 180, image);
+	uint64_t screenshotTime = os_gettime_ns() - startTime;
+
+	blog(LOG_INFO, "[test_source_screenshot] %.3f ms/screenshot (frame interval: %.3f ms)",
+	     (double)screenshotTime / iterations / 1000000.0, (double)obs_get_frame_interval_ns() / 1000000.0);
+
+	for (auto format : {"png", "jpg", "qoi", "rgba"}) {
+		QByteArray encodedImage;
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			Utils::Image::Encode(image, format, -1, encodedImage);
+		uint64_t encodeTime = os_gettime_ns() - startTime;
+
+		blog(LOG_INFO, "[test_source_screenshot] %s: %.3f ms/encode | %d bytes", format,
+		     (double)encodeTime / iterations / 1000000.0, (int)encodedImage.size());
+	}
+
+	// Pixel kernels against the per-line copies and Qt conversions they replace, at a typical canvas resolution
+	QImage largeImage(1920, 1080, QImage::Format_RGBA8888);
+	for (int y = 0; y < largeImage.height(); y++) {
+		uint8_t *line = largeImage.scanLine(y);
+		for (int x = 0; x < largeImage.width() * 4; x++)
+			line[x] = (uint8_t)(x ^ y);
+	}
+	const size_t largePixels = (size_t)largeImage.width() * largeImage.height();
+	QImage target(largeImage.width(), largeImage.height(), QImage::Format_RGBA8888);
+
+	auto benchmark = [iterations](const char *name, std::function<void()> current, std::function<void()> kernel) {
+		uint64_t startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			current();
+		uint64_t currentTime = os_gettime_ns() - startTime;
+
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			kernel();
+		uint64_t kernelTime = os_gettime_ns() - startTime;
+
+		blog(LOG_INFO, "[test_source_screenshot] %s: %.3f ms (current) | %.3f ms (kernel)", name,
+		     (double)currentTime / iterations / 1000000.0, (double)kernelTime / iterations / 1000000.0);
+	};
+
+	benchmark(
+		"Row copy",
+		[&]() {
+			for (int y = 0; y < largeImage.height(); y++)
+				memcpy(target.scanLine(y), largeImage.constScanLine(y), largeImage.bytesPerLine());
+		},
+		[&]() {
+			uint32_t lineSize = largeImage.bytesPerLine();
+			Utils::Image::CopyRows(target.bits(), lineSize, largeImage.constBits(), lineSize, lineSize,
+					       largeImage.height());
+		});
+	benchmark(
+		"RGBA to BGRA", [&]() { target = largeImage.rgbSwapped(); },
+		[&]() { Utils::Image::SwizzleRedBlue(target.bits(), largeImage.constBits(), largePixels); });
+	benchmark(
+		"RGBA to RGB", [&]() { largeImage.convertToFormat(QImage::Format_RGB888); },
+		[&]() {
+			QImage rgbImage(largeImage.width(), largeImage.height(), QImage::Format_RGB888);
+			for (int y = 0; y < rgbImage.height(); y++)
+				Utils::Image::PackRgb(rgbImage.scanLine(y), largeImage.constScanLine(y), rgbImage.width());
+		});
+	benchmark(
+		"Downscale to 640x360",
+		[&]() { largeImage.scaled(640, 360, Qt::IgnoreAspectRatio, Qt::SmoothTransformation); },
+		[&]() { Utils::Image::Downscale(largeImage, 640, 360); });
+	benchmark(
+		"Downscale to 500x281",
+		[&]() { largeImage.scaled(500, 281, Qt::IgnoreAspectRatio, Qt::SmoothTransformation); },
+		[&]() { Utils::Image::Downscale(largeImage, 500, 281); });
+
+	blog(LOG_INFO, "[test_source_screenshot] Test done.");
+}
+
+void test_persistent_data()
+{
+	blog(LOG_INFO, "[test_persistent_data] Comparing persistent data file access to the in-memory store...");
+
+	const size_t iterations = 1000;
+	std::string path = QDir::temp().filePath("obsWebSocketPersistentDataTest.json").toStdString();
+
+	json slotValue = {{"counter", 0}, {"label", "obs-websocket test"}};
+
+	// What every GetPersistentData and SetPersistentData call previously did
+	uint64_t startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++) {
+		json persistentData;
+		Utils::Json::GetJsonFileContent(path, persistentData);
+		persistentData["slot" + std::to_string(i % 16)] = slotValue;
+		Utils::Json::SetJsonFileContent(path, persistentData);
+	}
+	uint64_t fileSetTime = os_gettime_ns() - startTime;
+
+	startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++) {
+		json persistentData;
+		Utils::Json::GetJsonFileContent(path, persistentData);
+		persistentData.contains("slot" + std::to_string(i % 16));
+	}
+	uint64_t fileGetTime = os_gettime_ns() - startTime;
+
+	PersistentDataStore persistentDataStore;
+	PersistentDataStore::Realm realm{"test", path};
+	startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++)
+		persistentDataStore.Set(realm, "slot" + std::to_string(i % 16), slotValue);
+	uint64_t storeSetTime = os_gettime_ns() - startTime;
+
+	startTime = os_gettime_ns();
+	for (size_t i = 0; i < iterations; i++)
+		persistentDataStore.Get(realm, "slot" + std::to_string(i % 16));
+	uint64_t storeGetTime = os_gettime_ns() - startTime;
+
+	startTime = os_gettime_ns();
+	persistentDataStore.Flush();
+	uint64_t flushTime = os_gettime_ns() - startTime;
+
+	json persistentData;
+	if (!Utils::Json::GetJsonFileContent(path, persistentData) || persistentData["slot15"] != slotValue)
+		blog(LOG_ERROR, "[test_persistent_data] Flushed file does not contain the stored data.");
+
+	// Concurrent increments must not lose updates
+	QThreadPool threadPool;
+	for (size_t i = 0; i < iterations; i++)
+		threadPool.start(Utils::Compat::CreateFunctionRunnable([&persistentDataStore, &realm]() {
+			json slotValue;
+			persistentDataStore.Increment(realm, "counter", 1, slotValue);
+		}));
+	threadPool.waitForDone();
+	if (persistentDataStore.Get(realm, "counter") != iterations)
+		blog(LOG_ERROR, "[test_persistent_data] Concurrent increments lost updates: %s",
+		     persistentDataStore.Get(realm, "counter").dump().c_str());
+
+	json currentValue;
+	if (!persistentDataStore.CompareAndSet(realm, "lock", nullptr, "owner", currentValue) ||
+	    persistentDataStore.CompareAndSet(realm, "lock", nullptr, "other", currentValue) || currentValue != "owner")
+		blog(LOG_ERROR, "[test_persistent_data] Compare-and-set did not respect the expected value.");
+	persistentDataStore.Flush();
+
+	blog(LOG_INFO, "[test_persistent_data] File: %.3f us/set, %.3f us/get | Store: %.3f us/set, %.3f us/get, %.3f ms flush",
+	     (double)fileSetTime / iterations / 1000.0, (double)fileGetTime / iterations / 1000.0,
+	     (double)storeSetTime / iterations / 1000.0, (double)storeGetTime / iterations / 1000.0, (double)flushTime / 1000000.0);
+
+	QFile::remove(QString::fromStdString(path));
+
+	blog(LOG_INFO, "[test_persistent_data] Test done.");
+}
+
+// Settings of the kind which make up most of the time of `GetInputSettings` and `SetInputSettings`
+json create_test_settings()
+{
+	json settings;
+	settings["browser"] = {{"url", "https://example.com/overlay/alerts?theme=dark&channel=obs-websocket"},
+			       {"width", 1920},
+			       {"height", 1080},
+			       {"fps", 60},
+			       {"fps_custom", true},
+			       {"reroute_audio", true},
+			       {"css", std::string(16384, 'c')}};
+	settings["text"] = {{"text", std::string(4096, 't')},
+			    {"font", {{"face", "Arial"}, {"size", 256}, {"style", "Regular"}, {"flags", 0}}},
+			    {"color", 4294967295},
+			    {"opacity", 100},
+			    {"outline", true},
+			    {"outline_size", 2.5}};
+
+	json playlist = json::array();
+	for (int i = 0; i < 200; i++)
+		playlist.push_back(
+			{{"value", "/media/clips/clip_" + std::to_string(i) + ".mp4"}, {"hidden", false}, {"selected", i == 0}});
+	settings["media"] = {{"playlist", playlist}, {"loop", true}, {"shuffle", false}, {"network_caching", 400}};
+
+	return settings;
+}
+
+void test_obs_data_conversion()
+{
+	blog(LOG_INFO, "[test_obs_data_conversion] Converting settings between JSON and obs_data...");
+
+	const size_t iterations = 200;
+
+	for (auto &[name, settings] : create_test_settings().items()) {
+		OBSDataAutoRelease obsData = Utils::Json::JsonToObsData(settings);
+		if (Utils::Json::ObsDataToJson(obsData) != settings)
+			blog(LOG_ERROR, "[test_obs_data_conversion] %s: Round trip does not match.", name.c_str());
+
+		// Only allocations made through libobs can be counted, which are those of the obs_data being built. The counter is
+		// shared with every other thread, so this is only an estimate and not checked for leaks
+		long startAllocs = bnum_allocs();
+		obs_data_t *counted = Utils::Json::JsonToObsData(settings);
+		long obsDataAllocs = bnum_allocs() - startAllocs;
+		obs_data_release(counted);
+
+		uint64_t startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++) {
+			OBSDataAutoRelease converted = Utils::Json::JsonToObsData(settings);
+		}
+		uint64_t toObsDataTime = os_gettime_ns() - startTime;
+
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			Utils::Json::ObsDataToJson(obsData);
+		uint64_t toJsonTime = os_gettime_ns() - startTime;
+
+		blog(LOG_INFO, "[test_obs_data_conversion] %s: JsonToObsData: %.3f us, %ld allocations | ObsDataToJson: %.3f us",
+		     name.c_str(), (double)toObsDataTime / iterations / 1000.0, obsDataAllocs,
+		     (double)toJsonTime / iterations / 1000.0);
+	}
+
+	blog(LOG_INFO, "[test_obs_data_conversion] Test done.");
+}
+
+void test_obs_data_serialization()
+{
+	blog(LOG_INFO, "[test_obs_data_serialization] Serializing settings without building a json object...");
+
+	const size_t iterations = 200;
+
+	for (auto &[name, settings] : create_test_settings().items()) {
+		OBSDataAutoRelease obsData = Utils::Json::JsonToObsData(settings);
+		json expected = Utils::Json::ObsDataToJson(obsData);
+		if (json::parse(Utils::Json::ObsDataToJsonString(obsData)) != expected ||
+		    json::from_msgpack(Utils::Json::ObsDataToMsgPack(obsData)) != expected)
+			blog(LOG_ERROR, "[test_obs_data_serialization] %s: Serialized settings do not match.", name.c_str());
+
+		// The way `InputSettingsChanged` is sent
+		Utils::Json::RawFields rawFields;
+		json message = {{"eventType", "InputSettingsChanged"}, {"eventData", {{"inputSettings", rawFields.Add(obsData)}}}};
+		json expectedMessage = {{"eventType", "InputSettingsChanged"}, {"eventData", {{"inputSettings", expected}}}};
+		if (json::parse(rawFields.Dump(message)) != expectedMessage ||
+		    json::from_msgpack(rawFields.ToMsgPack(message)) != expectedMessage)
+			blog(LOG_ERROR, "[test_obs_data_serialization] %s: Spliced message does not match.", name.c_str());
+
+		uint64_t startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			Utils::Json::ObsDataToJson(obsData).dump();
+		uint64_t domTime = os_gettime_ns() - startTime;
+
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			json::to_msgpack(Utils::Json::ObsDataToJson(obsData));
+		uint64_t domMsgPackTime = os_gettime_ns() - startTime;
+
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			Utils::Json::ObsDataToJsonString(obsData);
+		uint64_t directTime = os_gettime_ns() - startTime;
+
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++)
+			Utils::Json::ObsDataToMsgPack(obsData);
+		uint64_t directMsgPackTime = os_gettime_ns() - startTime;
+
+		// Both encodings of a whole event, as for a broadcast to Json and MsgPack sessions
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++) {
+			json domMessage = {{"eventType", "InputSettingsChanged"},
+					   {"eventData", {{"inputSettings", Utils::Json::ObsDataToJson(obsData)}}}};
+			domMessage.dump();
+			json::to_msgpack(domMessage);
+		}
+		uint64_t domEventTime = os_gettime_ns() - startTime;
+
+		startTime = os_gettime_ns();
+		for (size_t i = 0; i < iterations; i++) {
+			Utils::Json::RawFields eventRawFields;
+			json rawMessage = {{"eventType", "InputSettingsChanged"},
+					   {"eventData", {{"inputSettings", eventRawFields.Add(obsData)}}}};
+			eventRawFields.Dump(rawMessage);
+			eventRawFields.ToMsgPack(rawMessage);
+		}
+		uint64_t rawEventTime = os_gettime_ns() - startTime;
+
+		blog(LOG_INFO,
+		     "[test_obs_data_serialization] %s: json object + dump: %.3f us | json object + msgpack: %.3f us | "
+		     "direct json: %.3f us | direct msgpack: %.3f us | event with json object: %.3f us | "
+		     "event with raw fields: %.3f us",
+		     name.c_str(), (double)domTime / iterations / 1000.0, (double)domMsgPackTime / iterations / 1000.0,
+		     (double)directTime / iterations / 1000.0, (double)directMsgPackTime / iterations / 1000.0,
+		     (double)domEventTime / iterations / 1000.0, (double)rawEventTime / iterations / 1000.0);
+	}
+
+	blog(LOG_INFO, "[test_obs_data_serialization] Test done.");
+}
 #endif
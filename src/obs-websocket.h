@@ -40,6 +40,24 @@ typedef std::shared_ptr<WebSocketApi> WebSocketApiPtr;
 class WebSocketServer;
 typedef std::shared_ptr<WebSocketServer> WebSocketServerPtr;
 
+class AnimationManager;
+typedef std::shared_ptr<AnimationManager> AnimationManagerPtr;
+
+class RequestScheduler;
+typedef std::shared_ptr<RequestScheduler> RequestSchedulerPtr;
+
+class PersistentDataStore;
+typedef std::shared_ptr<PersistentDataStore> PersistentDataStorePtr;
+
+class ScreenshotRenderer;
+typedef std::shared_ptr<ScreenshotRenderer> ScreenshotRendererPtr;
+
+class ScreenshotSaver;
+typedef std::shared_ptr<ScreenshotSaver> ScreenshotSaverPtr;
+
+class ScreenshotStreamManager;
+typedef std::shared_ptr<ScreenshotStreamManager> ScreenshotStreamManagerPtr;
+
 os_cpu_usage_info_t *GetCpuUsageInfo();
 
 ConfigPtr GetConfig();
@@ -50,4 +68,16 @@ WebSocketApiPtr GetWebSocketApi();
 
 WebSocketServerPtr GetWebSocketServer();
 
+AnimationManagerPtr GetAnimationManager();
+
+RequestSchedulerPtr GetRequestScheduler();
+
+PersistentDataStorePtr GetPersistentDataStore();
+
+ScreenshotRendererPtr GetScreenshotRenderer();
+
+ScreenshotSaverPtr GetScreenshotSaver();
+
+ScreenshotStreamManagerPtr GetScreenshotStreamManager();
+
 bool IsDebugEnabled();
@@ -0,0 +1,164 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <iterator>
+#include <util/profiler.hpp>
+
+#include "AnimationManager.h"
+#include "../obs-websocket.h"
+
+AnimationManager::AnimationManager()
+{
+	obs_add_tick_callback(ObsTickCallback, this);
+}
+
+AnimationManager::~AnimationManager()
+{
+	obs_remove_tick_callback(ObsTickCallback, this);
+
+	std::lock_guard<std::mutex> lock(_animationsMutex);
+	if (!_animations.empty())
+		blog_debug("[AnimationManager::~AnimationManager] Dropping %zu running animations.", _animations.size());
+}
+
+uint64_t AnimationManager::Start(const std::string &animationType, const std::string &target, const json &targetData,
+				 uint64_t durationMs, AnimationEasing::AnimationEasing easing, UpdateCallback update)
+{
+	Animation animation;
+	animation.type = animationType;
+	animation.target = target;
+	animation.targetData = targetData;
+	animation.duration = durationMs * 1000000;
+	animation.easing = easing;
+	animation.update = std::make_shared<const UpdateCallback>(std::move(update));
+
+	uint64_t animationId;
+	std::vector<Animation> replacedAnimations;
+	{
+		std::lock_guard<std::mutex> lock(_animationsMutex);
+		animationId = animation.id = _nextAnimationId++;
+
+		// Two animations of the same target would fight over it every tick
+		auto it = std::stable_partition(_animations.begin(), _animations.end(),
+						[&target](const Animation &a) { return a.target != target; });
+		std::move(it, _animations.end(), std::back_inserter(replacedAnimations));
+		_animations.erase(it, _animations.end());
+
+		_animations.push_back(std::move(animation));
+	}
+
+	for (auto &replacedAnimation : replacedAnimations)
+		EmitAnimationEnded(replacedAnimation, true);
+
+	return animationId;
+}
+
+bool AnimationManager::Stop(uint64_t animationId)
+{
+	Animation animation;
+	{
+		std::lock_guard<std::mutex> lock(_animationsMutex);
+		auto it = std::find_if(_animations.begin(), _animations.end(),
+				       [animationId](const Animation &a) { return a.id == animationId; });
+		if (it == _animations.end())
+			return false;
+
+		animation = std::move(*it);
+		_animations.erase(it);
+	}
+
+	EmitAnimationEnded(animation, true);
+
+	return true;
+}
+
+void AnimationManager::ObsTickCallback(void *param, float)
+{
+	static_cast<AnimationManager *>(param)->Tick();
+}
+
+void AnimationManager::Tick()
+{
+	struct Step {
+		uint64_t id;
+		std::shared_ptr<const UpdateCallback> update;
+		float progress;
+		bool completed;
+		bool targetExists;
+	};
+	std::vector<Step> steps;
+	{
+		std::lock_guard<std::mutex> lock(_animationsMutex);
+		if (_animations.empty())
+			return;
+
+		uint64_t now = os_gettime_ns();
+		for (auto &animation : _animations) {
+			if (!animation.startTime)
+				animation.startTime = now;
+
+			uint64_t elapsed = now - animation.startTime;
+			bool completed = elapsed >= animation.duration;
+			float progress = completed ? 1.0f : float(double(elapsed) / double(animation.duration));
+			float easedProgress = AnimationEasing::Apply(animation.easing, progress);
+
+			steps.push_back({animation.id, animation.update, easedProgress, completed, true});
+		}
+	}
+
+	ScopeProfiler prof{"obs_websocket_animation_tick"};
+
+	// Applied outside of the lock, as updates emit events whose receivers may start or stop animations
+	for (auto &step : steps)
+		step.targetExists = (*step.update)(step.progress);
+
+	std::vector<std::pair<Animation, bool>> endedAnimations; // Animation, cancelled
+	{
+		std::lock_guard<std::mutex> lock(_animationsMutex);
+		for (auto &step : steps) {
+			if (step.targetExists && !step.completed)
+				continue;
+
+			// Animations which were stopped or replaced during the updates have already ended
+			auto it = std::find_if(_animations.begin(), _animations.end(),
+					       [&step](const Animation &a) { return a.id == step.id; });
+			if (it == _animations.end())
+				continue;
+
+			endedAnimations.emplace_back(std::move(*it), !step.targetExists);
+			_animations.erase(it);
+		}
+	}
+
+	// Emitted outside of the lock, as event receivers may start or stop animations
+	for (auto &endedAnimation : endedAnimations)
+		EmitAnimationEnded(endedAnimation.first, endedAnimation.second);
+}
+
+void AnimationManager::EmitAnimationEnded(const Animation &animation, bool cancelled)
+{
+	if (!_animationEndedCallback)
+		return;
+
+	json eventData = animation.targetData.is_object() ? animation.targetData : json::object();
+	eventData["animationId"] = animation.id;
+	eventData["animationType"] = animation.type;
+	eventData["cancelled"] = cancelled;
+	_animationEndedCallback(eventData);
+}
@@ -0,0 +1,76 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "types/AnimationEasing.h"
+#include "../utils/Json.h"
+
+// Runs animations started by requests on the graphics tick, so that clients do not have to send a request for every frame
+class AnimationManager {
+public:
+	// Applies the eased progress (0 to 1) of an animation. Returns false if its target no longer exists.
+	// Called from the graphics thread without the manager locked, and always called with 1 on the last tick of a completed
+	// animation. May still be called once after the animation has been stopped from another thread.
+	typedef std::function<bool(float)> UpdateCallback;
+
+	// Callback when an animation completes or is cancelled. Called from the graphics thread, so it must be set before any
+	// animation is started and is not changed afterwards
+	typedef std::function<void(json)> AnimationEndedCallback; // json eventData
+	inline void SetAnimationEndedCallback(AnimationEndedCallback cb) { _animationEndedCallback = cb; }
+
+	AnimationManager();
+	~AnimationManager();
+
+	// Starts an animation on the next tick, cancelling any running animation of the same target. Returns the animation ID.
+	// `targetData` is added to the `AnimationEnded` event.
+	uint64_t Start(const std::string &animationType, const std::string &target, const json &targetData, uint64_t durationMs,
+		       AnimationEasing::AnimationEasing easing, UpdateCallback update);
+	// Cancels an animation, leaving its target as it is. Returns false if no animation has the ID.
+	bool Stop(uint64_t animationId);
+
+	static inline float Lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+private:
+	struct Animation {
+		uint64_t id;
+		std::string type;
+		std::string target;
+		json targetData;
+		uint64_t duration; // Nanoseconds
+		AnimationEasing::AnimationEasing easing;
+		std::shared_ptr<const UpdateCallback> update; // Shared with the tick which is calling it
+		uint64_t startTime = 0; // Set on the first tick
+	};
+
+	AnimationEndedCallback _animationEndedCallback;
+
+	std::mutex _animationsMutex;
+	std::vector<Animation> _animations;
+	uint64_t _nextAnimationId = 1;
+
+	static void ObsTickCallback(void *param, float);
+	void Tick();
+	void EmitAnimationEnded(const Animation &animation, bool cancelled);
+};
@@ -0,0 +1,285 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <QSaveFile>
+#include <util/profiler.hpp>
+
+#include "PersistentDataStore.h"
+#include "../utils/Compat.h"
+#include "../utils/Obs.h"
+#include "plugin-macros.generated.h"
+
+#define GLOBAL_PERSISTENT_DATA_FILE_NAME "persistent_data.json"
+
+// Adds two integers without overflowing. Sums above INT64_MAX are kept as unsigned integers
+static bool AddIntegers(const json &a, const json &b, json &sum)
+{
+	auto isLarge = [](const json &value) {
+		return value.is_number_unsigned() && value.get<uint64_t>() > (uint64_t)INT64_MAX;
+	};
+
+	if (isLarge(a) && isLarge(b))
+		return false;
+
+	if (isLarge(a) || isLarge(b)) {
+		uint64_t large = (isLarge(a) ? a : b).get<uint64_t>();
+		int64_t other = (isLarge(a) ? b : a).get<int64_t>();
+		if (other >= 0) {
+			if ((uint64_t)other > UINT64_MAX - large)
+				return false;
+			sum = large + (uint64_t)other;
+		} else {
+			// Subtracting at most 2^63 from above INT64_MAX can not go below 0
+			sum = large - (uint64_t)(-(other + 1)) - 1;
+		}
+		return true;
+	}
+
+	int64_t x = a.get<int64_t>();
+	int64_t y = b.get<int64_t>();
+	if (y > 0 && x > INT64_MAX - y) {
+		sum = (uint64_t)x + (uint64_t)y;
+		return true;
+	}
+	if (y < 0 && x < INT64_MIN - y)
+		return false;
+
+	sum = x + y;
+	return true;
+}
+
+PersistentDataStore::PersistentDataStore()
+{
+	// A single writer keeps the writes of a file in order
+	_flushPool.setMaxThreadCount(1);
+
+	obs_frontend_add_event_callback(OnFrontendEvent, this);
+}
+
+PersistentDataStore::~PersistentDataStore()
+{
+	obs_frontend_remove_event_callback(OnFrontendEvent, this);
+
+	Flush();
+}
+
+bool PersistentDataStore::GetRealm(const std::string &realmName, Realm &realm)
+{
+	if (realmName == "OBS_WEBSOCKET_DATA_REALM_GLOBAL")
+		realm.path = Utils::Obs::StringHelper::GetModuleConfigPath(GLOBAL_PERSISTENT_DATA_FILE_NAME);
+	else if (realmName == "OBS_WEBSOCKET_DATA_REALM_PROFILE")
+		realm.path = Utils::Obs::StringHelper::GetCurrentProfilePath() + "/obsWebSocketPersistentData.json";
+	else
+		return false;
+
+	realm.name = realmName;
+	return true;
+}
+
+json PersistentDataStore::Get(const Realm &realm, const std::string &slotName)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Document &document = GetDocument(realm.path);
+
+	auto it = document.data.find(slotName);
+	if (it == document.data.end())
+		return nullptr;
+
+	return *it;
+}
+
+void PersistentDataStore::Set(const Realm &realm, const std::string &slotName, json slotValue)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	DataChange change;
+	SetSlot(realm, GetDocument(realm.path), slotName, std::move(slotValue), change);
+	lock.unlock();
+
+	SendDataChange(change);
+}
+
+bool PersistentDataStore::CompareAndSet(const Realm &realm, const std::string &slotName, const json &expectedValue,
+					json slotValue, json &currentValue)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	Document &document = GetDocument(realm.path);
+
+	auto it = document.data.find(slotName);
+	bool matches = it == document.data.end() ? expectedValue.is_null() : *it == expectedValue;
+	if (!matches) {
+		currentValue = it == document.data.end() ? json(nullptr) : *it;
+		return false;
+	}
+
+	currentValue = slotValue;
+	DataChange change;
+	SetSlot(realm, document, slotName, std::move(slotValue), change);
+	lock.unlock();
+
+	SendDataChange(change);
+	return true;
+}
+
+PersistentDataStore::IncrementResult PersistentDataStore::Increment(const Realm &realm, const std::string &slotName,
+								 const json &incrementBy, json &slotValue)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	Document &document = GetDocument(realm.path);
+
+	auto it = document.data.find(slotName);
+	json value = it == document.data.end() ? json(0) : *it;
+	if (!value.is_number())
+		return NotANumber;
+
+	// Integers stay integers, so that counters never lose precision
+	if (value.is_number_integer() && incrementBy.is_number_integer()) {
+		if (!AddIntegers(value, incrementBy, slotValue))
+			return Overflowed;
+	} else {
+		slotValue = value.get<double>() + incrementBy.get<double>();
+	}
+
+	DataChange change;
+	SetSlot(realm, document, slotName, slotValue, change);
+	lock.unlock();
+
+	SendDataChange(change);
+	return Incremented;
+}
+
+void PersistentDataStore::Flush()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		QueueFlush();
+	}
+
+	_flushPool.waitForDone();
+}
+
+// Must be called with the mutex held
+PersistentDataStore::Document &PersistentDataStore::GetDocument(const std::string &path)
+{
+	auto it = _documents.find(path);
+	if (it != _documents.end())
+		return it->second;
+
+	Document document;
+	json fileContent;
+	if (Utils::Json::GetJsonFileContent(path, fileContent) && fileContent.is_object())
+		document.data = std::move(fileContent);
+
+	return _documents.emplace(path, std::move(document)).first->second;
+}
+
+// Must be called with the mutex held
+void PersistentDataStore::SetSlot(const Realm &realm, Document &document, const std::string &slotName, json slotValue,
+				  DataChange &change)
+{
+	json &slot = document.data[slotName];
+	if (slot == slotValue)
+		return;
+
+	slot = std::move(slotValue);
+	document.dirty = true;
+	QueueFlush();
+
+	uint64_t sequence = ++_realmSequences[realm.name];
+	if (!_dataChangedCallback)
+		return;
+
+	change.callback = _dataChangedCallback;
+	change.eventData["realm"] = realm.name;
+	change.eventData["slotName"] = slotName;
+	change.eventData["slotValue"] = slot;
+	change.eventData["sequence"] = sequence;
+}
+
+// Must be called without the mutex held, as the callback may use the store again
+void PersistentDataStore::SendDataChange(DataChange &change)
+{
+	if (change.callback)
+		change.callback(std::move(change.eventData));
+}
+
+// Must be called with the mutex held
+void PersistentDataStore::QueueFlush()
+{
+	if (_flushQueued)
+		return;
+
+	_flushQueued = true;
+	_flushPool.start(Utils::Compat::CreateFunctionRunnable([this]() { WriteDirtyDocuments(); }));
+}
+
+void PersistentDataStore::WriteDirtyDocuments()
+{
+	ScopeProfiler prof{"obs_websocket_persistent_data_flush"};
+
+	// Snapshots are taken under the lock, and written without it
+	std::vector<std::pair<std::string, json>> writes;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_flushQueued = false;
+		for (auto &[path, document] : _documents) {
+			if (!document.dirty)
+				continue;
+
+			writes.emplace_back(path, document.data);
+			document.dirty = false;
+		}
+	}
+
+	for (auto &[path, data] : writes) {
+		// Written to a temporary file which replaces the previous one once complete, so that a crash never truncates it
+		QByteArray content = QByteArray::fromStdString(data.dump(2));
+		QSaveFile file(QString::fromStdString(path));
+		if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+			blog(LOG_ERROR, "[PersistentDataStore::WriteDirtyDocuments] Failed to write persistent data to `%s`",
+			     path.c_str());
+	}
+}
+
+// Files of other profiles are loaded again when they are next used, in case they were changed while not in use
+void PersistentDataStore::EvictCleanDocuments()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto it = _documents.begin(); it != _documents.end();) {
+		if (it->second.dirty)
+			++it;
+		else
+			it = _documents.erase(it);
+	}
+}
+
+void PersistentDataStore::OnFrontendEvent(enum obs_frontend_event event, void *private_data)
+{
+	auto persistentDataStore = static_cast<PersistentDataStore *>(private_data);
+
+	switch (event) {
+	case OBS_FRONTEND_EVENT_PROFILE_CHANGING:
+	case OBS_FRONTEND_EVENT_EXIT:
+		persistentDataStore->Flush();
+		break;
+	case OBS_FRONTEND_EVENT_PROFILE_CHANGED:
+		persistentDataStore->EvictCleanDocuments();
+		break;
+	default:
+		break;
+	}
+}
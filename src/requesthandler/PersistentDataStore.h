@@ -0,0 +1,102 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <QThreadPool>
+#include <obs-frontend-api.h>
+
+#include "../utils/Json.h"
+
+// Keeps persistent data realms in memory. Modified files are written in the background, with every change made while a
+// write is in progress coalesced into the next one. All operations on slots are atomic with respect to each other.
+class PersistentDataStore {
+public:
+	struct Realm {
+		std::string name;
+		std::string path;
+	};
+
+	enum IncrementResult {
+		Incremented,
+		NotANumber,
+		Overflowed,
+	};
+
+	// Callback for every change to the value of a slot. Called once the store is unlocked, so that the callback may use
+	// the store. Changes may therefore be reported out of order, which their per-realm `sequence` is for
+	typedef std::function<void(json)> DataChangedCallback; // json eventData
+	inline void SetDataChangedCallback(DataChangedCallback cb)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_dataChangedCallback = cb;
+	}
+
+	PersistentDataStore();
+	~PersistentDataStore();
+
+	// Returns false if the realm is not valid
+	static bool GetRealm(const std::string &realmName, Realm &realm);
+
+	// Returns `null` if the slot is not set
+	json Get(const Realm &realm, const std::string &slotName);
+	void Set(const Realm &realm, const std::string &slotName, json slotValue);
+	// Sets the slot only if its value equals `expectedValue`, where `null` expects it to not be set.
+	// `currentValue` is set to the value of the slot after the operation. Returns whether the slot was set
+	bool CompareAndSet(const Realm &realm, const std::string &slotName, const json &expectedValue, json slotValue,
+			   json &currentValue);
+	// A slot which is not set counts as 0. The slot is left unchanged if it holds something else than a number, or if an
+	// integer increment does not fit in 64 bits
+	IncrementResult Increment(const Realm &realm, const std::string &slotName, const json &incrementBy, json &slotValue);
+
+	// Writes every modified file and waits for it
+	void Flush();
+
+private:
+	struct Document {
+		json data = json::object();
+		bool dirty = false;
+	};
+
+	// Built by SetSlot with the store locked, and sent by SendDataChange once it is unlocked
+	struct DataChange {
+		DataChangedCallback callback;
+		json eventData;
+	};
+
+	DataChangedCallback _dataChangedCallback;
+
+	std::mutex _mutex;
+	std::map<std::string, Document> _documents;
+	std::map<std::string, uint64_t> _realmSequences; // Realm name -> number of the last change
+	bool _flushQueued = false;
+	QThreadPool _flushPool;
+
+	Document &GetDocument(const std::string &path);
+	void SetSlot(const Realm &realm, Document &document, const std::string &slotName, json slotValue, DataChange &change);
+	static void SendDataChange(DataChange &change);
+	void QueueFlush();
+	void WriteDirtyDocuments();
+	void EvictCleanDocuments();
+
+	static void OnFrontendEvent(enum obs_frontend_event event, void *private_data);
+};
@@ -17,30 +17,64 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
 #include <queue>
+#include <optional>
+#include <algorithm>
 #include <condition_variable>
 #include <util/profiler.hpp>
 
 #include "RequestBatchHandler.h"
+#include "RequestBatchTransaction.h"
 #include "../utils/Compat.h"
 #include "../obs-websocket.h"
+#include "../Config.h"
+
+#define MAX_REQUEST_REPEAT 1000
+#define MAX_GLOBAL_TEMPLATES 256
+
+static std::mutex globalTemplatesMutex;
+static std::map<std::string, RequestBatchTemplatePtr> globalTemplates;
 
 struct SerialFrameBatch {
 	RequestHandler &requestHandler;
-	std::queue<RequestBatchRequest> requests;
+	std::queue<const RequestBatchRequest *> requests;
 	std::vector<RequestResult> results;
 	json &variables;
 	bool haltOnFailure;
 
+	// Atomic batches are processed within a single tick, and rolled back on failure
+	bool atomic;
+	RequestBatchTransaction transaction;
+
+	// Control flow state of the request at the front of the queue
+	size_t repeatIteration = 0;
+	RequestStatus::RequestStatus lastStatus = RequestStatus::Unknown;
+
 	size_t frameCount = 0;
 	size_t sleepUntilFrame = 0;
 	std::mutex conditionMutex;
 	std::condition_variable condition;
 
-	SerialFrameBatch(RequestHandler &requestHandler, json &variables, bool haltOnFailure)
+	// Per-frame processing limits. 0 is unlimited
+	size_t requestBudget = 0;
+	uint64_t timeBudget = 0; // Nanoseconds
+
+	// Tick statistics, reported once the batch has finished
+	size_t processingTicks = 0;
+	size_t overBudgetTicks = 0;
+	uint64_t totalTickTime = 0;
+	uint64_t maxTickTime = 0;
+
+	SerialFrameBatch(RequestHandler &requestHandler, json &variables, bool haltOnFailure, bool atomic)
 		: requestHandler(requestHandler),
 		  variables(variables),
-		  haltOnFailure(haltOnFailure)
+		  haltOnFailure(haltOnFailure || atomic),
+		  atomic(atomic)
 	{
+		auto conf = GetConfig();
+		if (conf) {
+			requestBudget = conf->SerialFrameRequestBudget;
+			timeBudget = (uint64_t)conf->SerialFrameTimeBudget * 1000;
+		}
 	}
 };
 
@@ -54,12 +88,17 @@ struct ParallelBatchResults {
 	ParallelBatchResults(RequestHandler &requestHandler) : requestHandler(requestHandler) {}
 };
 
-// `{"inputName": "inputNameVariable"}` is essentially `inputName = inputNameVariable`
-static void PreProcessVariables(const json &variables, RequestBatchRequest &request)
+// `{"inputName": "inputNameVariable"}` is essentially `inputName = inputNameVariable`.
+// Requests may belong to a template, so they are never modified. Requests with input variables are copied into
+// `processedRequest` instead, and the request to process is returned.
+static const RequestBatchRequest &PreProcessVariables(const json &variables, const RequestBatchRequest &request,
+						      std::optional<RequestBatchRequest> &processedRequest)
 {
 	if (variables.empty() || !request.InputVariables.is_object() || request.InputVariables.empty() ||
 	    !request.RequestData.is_object())
-		return;
+		return request;
+
+	processedRequest.emplace(request);
 
 	for (auto &[key, value] : request.InputVariables.items()) {
 		if (!value.is_string()) {
@@ -69,7 +108,7 @@ static void PreProcessVariables(const json &variables, RequestBatchRequest &requ
 			continue;
 		}
 
-		std::string valueString = value;
+		const std::string &valueString = value.get_ref<const std::string &>();
 		if (!variables.contains(valueString)) {
 			blog_debug(
 				"[WebSocketServer::ProcessRequestBatch] `inputVariables` requested variable `%s`, but it does not exist. Skipping!",
@@ -77,10 +116,11 @@ static void PreProcessVariables(const json &variables, RequestBatchRequest &requ
 			continue;
 		}
 
-		request.RequestData[key] = variables[valueString];
+		processedRequest->RequestData[key] = variables[valueString];
 	}
 
-	request.HasRequestData = !request.RequestData.empty();
+	processedRequest->HasRequestData = !processedRequest->RequestData.empty();
+	return *processedRequest;
 }
 
 // `{"sceneItemIdVariable": "sceneItemId"}` is essentially `sceneItemIdVariable = sceneItemId`
@@ -97,7 +137,7 @@ static void PostProcessVariables(json &variables, const RequestBatchRequest &req
 			continue;
 		}
 
-		std::string valueString = value;
+		const std::string &valueString = value.get_ref<const std::string &>();
 		if (!requestResult.ResponseData.contains(valueString)) {
 			blog_debug(
 				"[WebSocketServer::ProcessRequestBatch] `outputVariables` requested responseData field `%s`, but it does not exist. Skipping!",
@@ -109,6 +149,129 @@ static void PostProcessVariables(json &variables, const RequestBatchRequest &req
 	}
 }
 
+// `{"variable": "isLive", "equals": true}` runs the request only if `isLive == true`
+static RequestStatus::RequestStatus EvaluateCondition(const json &variables, const json &condition,
+						      RequestStatus::RequestStatus lastStatus, std::string &comment)
+{
+	if (condition.is_null())
+		return RequestStatus::NoError;
+
+	if (!condition.is_object()) {
+		comment = "The request's `condition` is not an object.";
+		return RequestStatus::InvalidRequestFieldType;
+	}
+
+	bool hasVariable = condition.contains("variable") && !condition["variable"].is_null();
+	bool hasPreviousResult = condition.contains("previousResult") && !condition["previousResult"].is_null();
+	if (!hasVariable && !hasPreviousResult) {
+		comment = "The request's `condition` must contain a `variable` or a `previousResult`.";
+		return RequestStatus::MissingRequestField;
+	}
+
+	bool met = true;
+
+	if (hasVariable) {
+		if (!condition["variable"].is_string()) {
+			comment = "The `variable` of the request's `condition` is not a string.";
+			return RequestStatus::InvalidRequestFieldType;
+		}
+
+		const std::string &variableName = condition["variable"].get_ref<const std::string &>();
+		if (!variables.contains(variableName))
+			met = false;
+		else if (condition.contains("equals"))
+			met = variables[variableName] == condition["equals"];
+		else
+			met = !variables[variableName].is_null() && variables[variableName] != false;
+	}
+
+	if (hasPreviousResult) {
+		if (!condition["previousResult"].is_boolean()) {
+			comment = "The `previousResult` of the request's `condition` is not a boolean.";
+			return RequestStatus::InvalidRequestFieldType;
+		}
+
+		// Without a previously processed request there is no result to compare against
+		bool previousResult = lastStatus == RequestStatus::Success;
+		met = met && lastStatus != RequestStatus::Unknown && previousResult == condition["previousResult"].get<bool>();
+	}
+
+	if (condition.contains("negate") && !condition["negate"].is_null()) {
+		if (!condition["negate"].is_boolean()) {
+			comment = "The `negate` of the request's `condition` is not a boolean.";
+			return RequestStatus::InvalidRequestFieldType;
+		}
+
+		if (condition["negate"].get<bool>())
+			met = !met;
+	}
+
+	if (!met) {
+		comment = "The request's condition was not met.";
+		return RequestStatus::RequestSkipped;
+	}
+
+	return RequestStatus::NoError;
+}
+
+static RequestStatus::RequestStatus GetRepeatCount(const json &repeat, size_t &repeatCount, std::string &comment)
+{
+	repeatCount = 1;
+	if (repeat.is_null())
+		return RequestStatus::NoError;
+
+	if (!repeat.is_number_unsigned()) {
+		comment = "The request's `repeat` is not a positive number.";
+		return RequestStatus::InvalidRequestFieldType;
+	}
+
+	repeatCount = repeat;
+	if (repeatCount < 1 || repeatCount > MAX_REQUEST_REPEAT) {
+		comment = "The request's `repeat` is outside of the allowed range of 1 to " +
+			  std::to_string(MAX_REQUEST_REPEAT) + ".";
+		return RequestStatus::RequestFieldOutOfRange;
+	}
+
+	return RequestStatus::NoError;
+}
+
+// Processes one iteration of a serial batch request. Returns true if the request should be processed again.
+static bool ProcessSerialRequest(RequestHandler &requestHandler, json &variables, const RequestBatchRequest &request,
+				 size_t iteration, RequestStatus::RequestStatus &lastStatus, RequestResult &requestResult,
+				 RequestBatchTransaction *transaction = nullptr)
+{
+	std::string comment;
+	size_t repeatCount;
+	RequestStatus::RequestStatus statusCode = GetRepeatCount(request.Repeat, repeatCount, comment);
+	// The condition is only checked when the request is first reached, not on each repeat
+	if (statusCode == RequestStatus::NoError && iteration == 0)
+		statusCode = EvaluateCondition(variables, request.Condition, lastStatus, comment);
+	if (statusCode != RequestStatus::NoError) {
+		requestResult = RequestResult::Error(statusCode, comment);
+		return false;
+	}
+
+	std::optional<RequestBatchRequest> processedRequest;
+	const RequestBatchRequest &processed = PreProcessVariables(variables, request, processedRequest);
+
+	if (transaction)
+		requestResult = transaction->ProcessRequest(requestHandler, processed);
+	else
+		requestResult = requestHandler.ProcessRequest(processed);
+
+	PostProcessVariables(variables, processed, requestResult);
+
+	lastStatus = requestResult.StatusCode;
+
+	// Stop repeating on the first failure
+	return requestResult.StatusCode == RequestStatus::Success && iteration + 1 < repeatCount;
+}
+
+static inline bool ShouldHalt(bool haltOnFailure, RequestStatus::RequestStatus statusCode)
+{
+	return haltOnFailure && statusCode != RequestStatus::Success && statusCode != RequestStatus::RequestSkipped;
+}
+
 static void ObsTickCallback(void *param, float)
 {
 	ScopeProfiler prof{"obs_websocket_request_batch_frame_tick"};
@@ -127,34 +290,77 @@ static void ObsTickCallback(void *param, float)
 			serialFrameBatch->sleepUntilFrame = 0;
 	}
 
+	// Separate from the tick counter above, which also includes the ticks spent sleeping, so that the
+	// profiler shows the time spent processing requests against the frame budget
+	ScopeProfiler requestsProf{"obs_websocket_request_batch_frame_requests"};
+
+	uint64_t tickStartTime = os_gettime_ns();
+	size_t processedRequests = 0;
+
 	// Begin recursing any unprocessed requests
 	while (!serialFrameBatch->requests.empty()) {
-		// Fetch first in queue
-		RequestBatchRequest request = serialFrameBatch->requests.front();
-		// Pre-process batch variables
-		PreProcessVariables(serialFrameBatch->variables, request);
-		// Process request and get result
-		RequestResult requestResult = serialFrameBatch->requestHandler.ProcessRequest(request);
-		// Post-process batch variables
-		PostProcessVariables(serialFrameBatch->variables, request, requestResult);
-		// Add to results vector
-		serialFrameBatch->results.push_back(requestResult);
-		// Remove from front of queue
-		serialFrameBatch->requests.pop();
-
-		// If haltOnFailure and the request failed, clear the queue to make the batch return early.
-		if (serialFrameBatch->haltOnFailure && requestResult.StatusCode != RequestStatus::Success) {
-			serialFrameBatch->requests = std::queue<RequestBatchRequest>();
-			break;
+		// Resume on the next frame once this frame's budget is used up. At least one request is always processed.
+		// Atomic batches ignore the budget, as they must never be split across frames.
+		if (!serialFrameBatch->atomic) {
+			if (serialFrameBatch->requestBudget && processedRequests >= serialFrameBatch->requestBudget)
+				break;
+			if (serialFrameBatch->timeBudget && processedRequests &&
+			    os_gettime_ns() - tickStartTime >= serialFrameBatch->timeBudget)
+				break;
+		}
+
+		processedRequests++;
+
+		// Fetch first in queue. It is only popped once processed, so it is used in place
+		const RequestBatchRequest &request = *serialFrameBatch->requests.front();
+		// Process request (with batch variables and control flow) and get result
+		RequestResult requestResult;
+		bool repeat = ProcessSerialRequest(serialFrameBatch->requestHandler, serialFrameBatch->variables, request,
+						   serialFrameBatch->repeatIteration, serialFrameBatch->lastStatus,
+						   requestResult,
+						   serialFrameBatch->atomic ? &serialFrameBatch->transaction : nullptr);
+
+		size_t sleepFrames = requestResult.SleepFrames;
+
+		if (repeat) {
+			// Leave the request at the front of the queue for its next iteration
+			serialFrameBatch->repeatIteration++;
+		} else {
+			RequestStatus::RequestStatus statusCode = requestResult.StatusCode;
+
+			// Add to results vector
+			serialFrameBatch->results.push_back(std::move(requestResult));
+			// Remove from front of queue
+			serialFrameBatch->requests.pop();
+			serialFrameBatch->repeatIteration = 0;
+
+			// If haltOnFailure and the request failed, clear the queue to make the batch return early.
+			if (ShouldHalt(serialFrameBatch->haltOnFailure, statusCode)) {
+				serialFrameBatch->requests = std::queue<const RequestBatchRequest *>();
+				// Revert in the same tick, so the partially applied batch is never rendered
+				if (serialFrameBatch->atomic)
+					serialFrameBatch->transaction.Rollback();
+				break;
+			}
 		}
 
 		// If the processed request tells us to sleep, do so accordingly
-		if (requestResult.SleepFrames) {
-			serialFrameBatch->sleepUntilFrame = serialFrameBatch->frameCount + requestResult.SleepFrames;
+		if (sleepFrames) {
+			serialFrameBatch->sleepUntilFrame = serialFrameBatch->frameCount + sleepFrames;
 			break;
 		}
 	}
 
+	if (processedRequests) {
+		uint64_t tickTime = os_gettime_ns() - tickStartTime;
+		serialFrameBatch->processingTicks++;
+		serialFrameBatch->totalTickTime += tickTime;
+		if (tickTime > serialFrameBatch->maxTickTime)
+			serialFrameBatch->maxTickTime = tickTime;
+		if (serialFrameBatch->timeBudget && tickTime > serialFrameBatch->timeBudget)
+			serialFrameBatch->overBudgetTicks++;
+	}
+
 	// If request queue is empty, we can notify the paused worker thread
 	if (serialFrameBatch->requests.empty())
 		serialFrameBatch->condition.notify_one();
@@ -163,33 +369,52 @@ static void ObsTickCallback(void *param, float)
 std::vector<RequestResult>
 RequestBatchHandler::ProcessRequestBatch(QThreadPool &threadPool, SessionPtr session,
 					 RequestBatchExecutionType::RequestBatchExecutionType executionType,
-					 std::vector<RequestBatchRequest> &requests, json &variables, bool haltOnFailure)
+					 const std::vector<RequestBatchRequest> &requests, json &variables, bool haltOnFailure,
+					 bool atomic)
 {
 	RequestHandler requestHandler(session);
+
+	if (atomic) {
+		// Nothing is processed if any request of the batch cannot be rolled back
+		auto unsupportedRequest = std::find_if(requests.begin(), requests.end(), [](const RequestBatchRequest &request) {
+			return !RequestBatchTransaction::IsSupportedRequest(request.RequestType);
+		});
+		if (executionType != RequestBatchExecutionType::SerialFrame || unsupportedRequest != requests.end()) {
+			std::string comment = executionType != RequestBatchExecutionType::SerialFrame
+						      ? "Atomic request batches require the SerialFrame execution type."
+						      : "The atomic request batch was not processed, as `" +
+								unsupportedRequest->RequestType + "` requests cannot be rolled back.";
+			return std::vector<RequestResult>(
+				requests.size(), RequestResult::Error(RequestStatus::UnsupportedRequestBatchExecutionType, comment));
+		}
+	}
+
 	if (executionType == RequestBatchExecutionType::SerialRealtime) {
 		std::vector<RequestResult> ret;
+		RequestStatus::RequestStatus lastStatus = RequestStatus::Unknown;
 
 		// Recurse all requests in batch serially, processing the request then moving to the next one
 		for (auto &request : requests) {
-			PreProcessVariables(variables, request);
-
-			RequestResult requestResult = requestHandler.ProcessRequest(request);
+			RequestResult requestResult;
+			size_t iteration = 0;
+			while (ProcessSerialRequest(requestHandler, variables, request, iteration, lastStatus, requestResult))
+				iteration++;
 
-			PostProcessVariables(variables, request, requestResult);
+			bool halt = ShouldHalt(haltOnFailure, requestResult.StatusCode);
 
-			ret.push_back(requestResult);
+			ret.push_back(std::move(requestResult));
 
-			if (haltOnFailure && requestResult.StatusCode != RequestStatus::Success)
+			if (halt)
 				break;
 		}
 
 		return ret;
 	} else if (executionType == RequestBatchExecutionType::SerialFrame) {
-		SerialFrameBatch serialFrameBatch(requestHandler, variables, haltOnFailure);
+		SerialFrameBatch serialFrameBatch(requestHandler, variables, haltOnFailure, atomic);
 
-		// Create Request objects in the worker thread (avoid unnecessary processing in graphics thread)
+		// The caller's requests outlive the batch, as this waits for it to finish, so they are queued by reference
 		for (auto &request : requests)
-			serialFrameBatch.requests.push(request);
+			serialFrameBatch.requests.push(&request);
 
 		// Create a callback entry for the graphics thread to execute on each video frame
 		obs_add_tick_callback(ObsTickCallback, &serialFrameBatch);
@@ -201,7 +426,13 @@ RequestBatchHandler::ProcessRequestBatch(QThreadPool &threadPool, SessionPtr ses
 		// Remove the created callback entry since we don't need it anymore
 		obs_remove_tick_callback(ObsTickCallback, &serialFrameBatch);
 
-		return serialFrameBatch.results;
+		blog_debug(
+			"[RequestBatchHandler::ProcessRequestBatch] SerialFrame batch processed %zu requests over %zu ticks. Tick time: %.3f ms total, %.3f ms max. Ticks over budget: %zu",
+			serialFrameBatch.results.size(), serialFrameBatch.processingTicks,
+			serialFrameBatch.totalTickTime / 1000000.0, serialFrameBatch.maxTickTime / 1000000.0,
+			serialFrameBatch.overBudgetTicks);
+
+		return std::move(serialFrameBatch.results);
 	} else if (executionType == RequestBatchExecutionType::Parallel) {
 		ParallelBatchResults parallelResults(requestHandler);
 
@@ -211,10 +442,17 @@ RequestBatchHandler::ProcessRequestBatch(QThreadPool &threadPool, SessionPtr ses
 		// Submit each request as a task to the thread pool to be processed ASAP
 		for (auto &request : requests) {
 			threadPool.start(Utils::Compat::CreateFunctionRunnable([&parallelResults, &request]() {
-				RequestResult requestResult = parallelResults.requestHandler.ProcessRequest(request);
+				RequestResult requestResult;
+				// Control flow depends on the order of requests, which parallel batches do not have
+				if (!request.Condition.is_null() || !request.Repeat.is_null())
+					requestResult = RequestResult::Error(
+						RequestStatus::UnsupportedRequestBatchExecutionType,
+						"Request conditions and repeats are not supported in Parallel mode.");
+				else
+					requestResult = parallelResults.requestHandler.ProcessRequest(request);
 
 				std::unique_lock<std::mutex> lock(parallelResults.conditionMutex);
-				parallelResults.results.push_back(requestResult);
+				parallelResults.results.push_back(std::move(requestResult));
 				lock.unlock();
 				parallelResults.condition.notify_one();
 			}));
@@ -226,9 +464,105 @@ RequestBatchHandler::ProcessRequestBatch(QThreadPool &threadPool, SessionPtr ses
 			return parallelResults.results.size() == requestCount;
 		});
 
-		return parallelResults.results;
+		return std::move(parallelResults.results);
 	}
 
 	// Return empty vector if not a batch somehow
 	return std::vector<RequestResult>();
 }
+
+std::vector<RequestResult> RequestBatchHandler::ProcessRequestBatchInTick(SessionPtr session,
+								       const std::vector<RequestBatchRequest> &requests,
+								       json &variables, bool haltOnFailure, bool atomic)
+{
+	ScopeProfiler prof{"obs_websocket_request_batch_in_tick"};
+
+	RequestHandler requestHandler(session);
+	RequestBatchTransaction transaction;
+
+	std::vector<RequestResult> ret;
+	RequestStatus::RequestStatus lastStatus = RequestStatus::Unknown;
+
+	for (auto &request : requests) {
+		RequestResult requestResult;
+		size_t iteration = 0;
+		while (ProcessSerialRequest(requestHandler, variables, request, iteration, lastStatus, requestResult,
+					    atomic ? &transaction : nullptr))
+			iteration++;
+
+		bool halt = ShouldHalt(haltOnFailure || atomic, requestResult.StatusCode);
+
+		ret.push_back(std::move(requestResult));
+
+		if (halt) {
+			if (atomic)
+				transaction.Rollback();
+			break;
+		}
+	}
+
+	return ret;
+}
+
+json RequestBatchHandler::GetResultJson(RequestResult &&requestResult, const json &requestType, const json &requestId)
+{
+	json ret;
+
+	ret["requestType"] = requestType;
+
+	if (!requestId.is_null())
+		ret["requestId"] = requestId;
+
+	ret["requestStatus"] = {{"result", requestResult.StatusCode == RequestStatus::Success}, {"code", requestResult.StatusCode}};
+
+	if (!requestResult.Comment.empty())
+		ret["requestStatus"]["comment"] = requestResult.Comment;
+
+	if (requestResult.ResponseData.is_object())
+		ret["responseData"] = std::move(requestResult.ResponseData);
+
+	return ret;
+}
+
+json RequestBatchHandler::GetResultsJson(const RequestBatchTemplate &batchTemplate, std::vector<RequestResult> &results)
+{
+	json ret = json::array();
+	for (size_t i = 0; i < results.size(); i++)
+		ret.push_back(
+			GetResultJson(std::move(results[i]), batchTemplate.Requests[i].RequestType, batchTemplate.RequestIds[i]));
+
+	return ret;
+}
+
+RequestBatchTemplatePtr RequestBatchHandler::GetGlobalTemplate(const std::string &templateName)
+{
+	std::lock_guard<std::mutex> lock(globalTemplatesMutex);
+	auto it = globalTemplates.find(templateName);
+	if (it == globalTemplates.end())
+		return nullptr;
+
+	return it->second;
+}
+
+bool RequestBatchHandler::SetGlobalTemplate(const std::string &templateName, RequestBatchTemplatePtr batchTemplate)
+{
+	std::lock_guard<std::mutex> lock(globalTemplatesMutex);
+	// Global templates outlive the sessions which create them, so their number is bounded. Replacing one is always allowed.
+	auto it = globalTemplates.find(templateName);
+	if (it != globalTemplates.end()) {
+		it->second = batchTemplate;
+		return true;
+	}
+
+	if (globalTemplates.size() >= MAX_GLOBAL_TEMPLATES)
+		return false;
+
+	globalTemplates.emplace(templateName, batchTemplate);
+	return true;
+}
+
+bool RequestBatchHandler::RemoveGlobalTemplate(const std::string &templateName)
+{
+	std::lock_guard<std::mutex> lock(globalTemplatesMutex);
+	return globalTemplates.erase(templateName) > 0;
+}
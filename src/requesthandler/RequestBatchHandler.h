@@ -23,9 +23,32 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "RequestHandler.h"
 #include "rpc/RequestBatchRequest.h"
 
+// A validated request batch which is stored server-side and executed by name
+struct RequestBatchTemplate {
+	RequestBatchExecutionType::RequestBatchExecutionType ExecutionType;
+	bool HaltOnFailure;
+	bool Atomic;
+	std::vector<RequestBatchRequest> Requests;
+	std::vector<json> RequestIds;
+};
+
 namespace RequestBatchHandler {
+	// Requests are not modified, so the requests of a template can be processed without copying them
 	std::vector<RequestResult> ProcessRequestBatch(QThreadPool &threadPool, SessionPtr session,
 						       RequestBatchExecutionType::RequestBatchExecutionType executionType,
-						       std::vector<RequestBatchRequest> &requests, json &variables,
-						       bool haltOnFailure);
+						       const std::vector<RequestBatchRequest> &requests, json &variables,
+						       bool haltOnFailure, bool atomic = false);
+	// Processes all requests serially within the current graphics tick. Must be called from the graphics thread
+	std::vector<RequestResult> ProcessRequestBatchInTick(SessionPtr session, const std::vector<RequestBatchRequest> &requests,
+							     json &variables, bool haltOnFailure, bool atomic = false);
+
+	// One result of the `results` of a `RequestBatchResponse`. `requestId` is left out if null
+	json GetResultJson(RequestResult &&requestResult, const json &requestType, const json &requestId);
+	// Results of a template in the format of the `results` of a `RequestBatchResponse`
+	json GetResultsJson(const RequestBatchTemplate &batchTemplate, std::vector<RequestResult> &results);
+
+	// Templates which are shared by all sessions
+	RequestBatchTemplatePtr GetGlobalTemplate(const std::string &templateName);
+	bool SetGlobalTemplate(const std::string &templateName, RequestBatchTemplatePtr batchTemplate);
+	bool RemoveGlobalTemplate(const std::string &templateName);
 }
@@ -0,0 +1,337 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "RequestBatchTransaction.h"
+#include "../obs-websocket.h"
+
+typedef RequestBatchTransaction::SceneItemMap SceneItemMap;
+typedef RequestBatchTransaction::UndoOperation UndoOperation;
+typedef RequestBatchTransaction::UndoRecorder UndoRecorder;
+
+struct SceneItemState {
+	OBSScene scene;
+	OBSSource source;
+	OBSSceneItem sceneItem;
+	bool visible;
+	bool locked;
+	int index;
+	obs_blending_type blendMode;
+	obs_transform_info transform;
+	obs_sceneitem_crop crop;
+};
+
+struct FilterState {
+	OBSSource source;
+	OBSSource filter;
+	std::string name;
+	bool enabled;
+	size_t index;
+	std::string settings;
+};
+
+static SceneItemState GetSceneItemState(obs_sceneitem_t *sceneItem)
+{
+	SceneItemState state;
+	state.scene = obs_sceneitem_get_scene(sceneItem);
+	state.source = obs_sceneitem_get_source(sceneItem);
+	state.sceneItem = sceneItem;
+	state.visible = obs_sceneitem_visible(sceneItem);
+	state.locked = obs_sceneitem_locked(sceneItem);
+	state.index = obs_sceneitem_get_order_position(sceneItem);
+	state.blendMode = obs_sceneitem_get_blending_mode(sceneItem);
+	obs_sceneitem_get_info2(sceneItem, &state.transform);
+	obs_sceneitem_get_crop(sceneItem, &state.crop);
+	return state;
+}
+
+// Returns the scene item which currently stands in for `sceneItem`
+static obs_sceneitem_t *ResolveSceneItem(const SceneItemMap &recreatedSceneItems, obs_sceneitem_t *sceneItem)
+{
+	auto it = recreatedSceneItems.find(sceneItem);
+	return it == recreatedSceneItems.end() ? sceneItem : it->second.Get();
+}
+
+static void RestoreSceneItemState(obs_sceneitem_t *sceneItem, const SceneItemState &state)
+{
+	obs_sceneitem_set_info2(sceneItem, &state.transform);
+	obs_sceneitem_set_crop(sceneItem, &state.crop);
+	obs_sceneitem_set_visible(sceneItem, state.visible);
+	obs_sceneitem_set_locked(sceneItem, state.locked);
+	obs_sceneitem_set_blending_mode(sceneItem, state.blendMode);
+	obs_sceneitem_set_order_position(sceneItem, state.index);
+}
+
+static FilterState GetFilterState(obs_source_t *source, obs_source_t *filter)
+{
+	FilterState state;
+	state.source = source;
+	state.filter = filter;
+	state.name = obs_source_get_name(filter);
+	state.enabled = obs_source_enabled(filter);
+	state.index = Utils::Obs::NumberHelper::GetSourceFilterIndex(source, filter);
+	OBSDataAutoRelease settings = obs_source_get_settings(filter);
+	state.settings = obs_data_get_json(settings);
+	return state;
+}
+
+static void RestoreFilterState(const FilterState &state)
+{
+	if (state.name != obs_source_get_name(state.filter))
+		obs_source_set_name(state.filter, state.name.c_str());
+
+	obs_source_set_enabled(state.filter, state.enabled);
+
+	OBSDataAutoRelease currentSettings = obs_source_get_settings(state.filter);
+	if (state.settings != obs_data_get_json(currentSettings)) {
+		OBSDataAutoRelease settings = obs_data_create_from_json(state.settings.c_str());
+		obs_source_reset_settings(state.filter, settings);
+		obs_source_update_properties(state.filter);
+	}
+
+	Utils::Obs::ActionHelper::SetSourceFilterIndex(state.source, state.filter, state.index);
+}
+
+// Scene item ID of a created item is only known once the request has succeeded
+static UndoRecorder RecordSceneItemCreation(obs_scene_t *scene)
+{
+	OBSScene sceneRef = scene;
+	return [sceneRef](const RequestResult &requestResult) -> UndoOperation {
+		int64_t sceneItemId = requestResult.ResponseData["sceneItemId"];
+		// Held by reference rather than ID, as the item may be removed and recreated later in the batch
+		OBSSceneItem sceneItemRef = obs_scene_find_sceneitem_by_id(sceneRef, sceneItemId);
+		if (!sceneItemRef)
+			return nullptr;
+
+		return [sceneItemRef](SceneItemMap &recreatedSceneItems) {
+			obs_sceneitem_remove(ResolveSceneItem(recreatedSceneItems, sceneItemRef));
+		};
+	};
+}
+
+static UndoRecorder CaptureCreateSceneItem(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneAutoRelease scene = request.AcquireScene2(statusCode, comment);
+	if (!scene)
+		return nullptr;
+
+	return RecordSceneItemCreation(scene);
+}
+
+static UndoRecorder CaptureDuplicateSceneItem(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (request.Contains("destinationSceneName")) {
+		OBSSourceAutoRelease destinationSceneSource = request.AcquireSource(
+			"destinationCanvasUuid", "destinationSceneName", "destinationSceneUuid", statusCode, comment);
+		obs_scene_t *destinationScene = obs_scene_from_source(destinationSceneSource);
+		if (!destinationScene)
+			return nullptr;
+
+		return RecordSceneItemCreation(destinationScene);
+	}
+
+	OBSSceneItemAutoRelease sceneItem = request.AcquireSceneItem(statusCode, comment);
+	if (!sceneItem)
+		return nullptr;
+
+	return RecordSceneItemCreation(obs_sceneitem_get_scene(sceneItem));
+}
+
+// A removed scene item cannot be added back, so it is recreated from its previous state (with a new scene item ID)
+static UndoRecorder CaptureRemoveSceneItem(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneItemAutoRelease sceneItem = request.AcquireSceneItem(statusCode, comment);
+	if (!sceneItem)
+		return nullptr;
+
+	SceneItemState state = GetSceneItemState(sceneItem);
+	return [state](const RequestResult &) -> UndoOperation {
+		return [state](SceneItemMap &recreatedSceneItems) {
+			OBSSceneItemAutoRelease newSceneItem =
+				Utils::Obs::ActionHelper::CreateSceneItem(state.source, state.scene, state.visible);
+			if (!newSceneItem)
+				return;
+
+			RestoreSceneItemState(newSceneItem, state);
+			recreatedSceneItems[state.sceneItem.Get()] = newSceneItem.Get();
+		};
+	};
+}
+
+// Used for all requests which modify an existing scene item
+static UndoRecorder CaptureSceneItemState(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneItemAutoRelease sceneItem = request.AcquireSceneItem(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_SCENE_OR_GROUP);
+	if (!sceneItem)
+		return nullptr;
+
+	SceneItemState state = GetSceneItemState(sceneItem);
+	return [state](const RequestResult &) -> UndoOperation {
+		return [state](SceneItemMap &recreatedSceneItems) {
+			RestoreSceneItemState(ResolveSceneItem(recreatedSceneItems, state.sceneItem), state);
+		};
+	};
+}
+
+static UndoRecorder CaptureSceneItemTransforms(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneAutoRelease scene = request.AcquireScene2(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_SCENE_OR_GROUP);
+	if (!(scene && request.ValidateArray("sceneItemTransforms", statusCode, comment)))
+		return nullptr;
+
+	std::vector<SceneItemState> states;
+	for (auto &transform : request.RequestData["sceneItemTransforms"]) {
+		if (!transform.is_object() || !transform.contains("sceneItemId") || !transform["sceneItemId"].is_number_unsigned())
+			continue;
+
+		obs_sceneitem_t *sceneItem = obs_scene_find_sceneitem_by_id(scene, transform["sceneItemId"]);
+		if (sceneItem)
+			states.push_back(GetSceneItemState(sceneItem));
+	}
+
+	return [states](const RequestResult &) -> UndoOperation {
+		return [states](SceneItemMap &recreatedSceneItems) {
+			for (auto &state : states)
+				RestoreSceneItemState(ResolveSceneItem(recreatedSceneItems, state.sceneItem), state);
+		};
+	};
+}
+
+static UndoRecorder CaptureCreateSourceFilter(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSourceAutoRelease source = request.AcquireSource("canvasUuid", "sourceName", "sourceUuid", statusCode, comment);
+	if (!(source && request.ValidateString("filterName", statusCode, comment)))
+		return nullptr;
+
+	OBSSource sourceRef = source.Get();
+	std::string filterName = request.RequestData["filterName"];
+	return [sourceRef, filterName](const RequestResult &) -> UndoOperation {
+		// Filters may be renamed later in the batch, so hold on to the created filter itself
+		OBSSourceAutoRelease filter = obs_source_get_filter_by_name(sourceRef, filterName.c_str());
+		if (!filter)
+			return nullptr;
+
+		OBSSource filterRef = filter.Get();
+		return [sourceRef, filterRef](SceneItemMap &) {
+			obs_source_filter_remove(sourceRef, filterRef);
+		};
+	};
+}
+
+// Removing a filter only detaches it from its source, so the same filter is attached again
+static UndoRecorder CaptureRemoveSourceFilter(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	FilterPair pair = request.AcquireFilter(statusCode, comment);
+	if (!pair.filter)
+		return nullptr;
+
+	FilterState state = GetFilterState(pair.source, pair.filter);
+	return [state](const RequestResult &) -> UndoOperation {
+		return [state](SceneItemMap &) {
+			obs_source_filter_add(state.source, state.filter);
+			RestoreFilterState(state);
+		};
+	};
+}
+
+// Used for all requests which modify an existing filter
+static UndoRecorder CaptureFilterState(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	FilterPair pair = request.AcquireFilter(statusCode, comment);
+	if (!pair.filter)
+		return nullptr;
+
+	FilterState state = GetFilterState(pair.source, pair.filter);
+	return [state](const RequestResult &) -> UndoOperation {
+		return [state](SceneItemMap &) {
+			RestoreFilterState(state);
+		};
+	};
+}
+
+static const std::unordered_map<std::string, UndoRecorder (*)(const Request &)> captureMap{
+	{"CreateSceneItem", &CaptureCreateSceneItem},
+	{"RemoveSceneItem", &CaptureRemoveSceneItem},
+	{"DuplicateSceneItem", &CaptureDuplicateSceneItem},
+	{"SetSceneItemTransform", &CaptureSceneItemState},
+	{"SetSceneItemTransforms", &CaptureSceneItemTransforms},
+	{"SetSceneItemEnabled", &CaptureSceneItemState},
+	{"SetSceneItemLocked", &CaptureSceneItemState},
+	{"SetSceneItemIndex", &CaptureSceneItemState},
+	{"SetSceneItemBlendMode", &CaptureSceneItemState},
+	{"CreateSourceFilter", &CaptureCreateSourceFilter},
+	{"RemoveSourceFilter", &CaptureRemoveSourceFilter},
+	{"SetSourceFilterName", &CaptureFilterState},
+	{"SetSourceFilterIndex", &CaptureFilterState},
+	{"SetSourceFilterSettings", &CaptureFilterState},
+	{"SetSourceFilterEnabled", &CaptureFilterState},
+};
+
+bool RequestBatchTransaction::IsSupportedRequest(const std::string &requestType)
+{
+	// `Get` requests never modify state
+	if (requestType.rfind("Get", 0) == 0)
+		return true;
+
+	return captureMap.count(requestType) > 0;
+}
+
+RequestResult RequestBatchTransaction::ProcessRequest(RequestHandler &requestHandler, const Request &request)
+{
+	// The previous state has to be captured before the request changes it
+	UndoRecorder recorder;
+	auto it = captureMap.find(request.RequestType);
+	if (it != captureMap.end())
+		recorder = it->second(request);
+
+	RequestResult requestResult = requestHandler.ProcessRequest(request);
+
+	if (recorder && requestResult.StatusCode == RequestStatus::Success) {
+		UndoOperation undo = recorder(requestResult);
+		if (undo)
+			_undoOperations.push_back(std::move(undo));
+	}
+
+	return requestResult;
+}
+
+void RequestBatchTransaction::Rollback()
+{
+	blog_debug("[RequestBatchTransaction::Rollback] Reverting %zu requests.", _undoOperations.size());
+
+	SceneItemMap recreatedSceneItems;
+	for (auto it = _undoOperations.rbegin(); it != _undoOperations.rend(); ++it)
+		(*it)(recreatedSceneItems);
+
+	_undoOperations.clear();
+}
@@ -0,0 +1,47 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "RequestHandler.h"
+
+// Records how to revert the requests of an atomic request batch, so that a failed batch can be rolled back
+class RequestBatchTransaction {
+public:
+	// Removed scene items are recreated with a new scene item ID during a rollback. Maps each removed scene item to the
+	// scene item which replaced it, so that earlier operations of the same batch apply to the replacement
+	typedef std::unordered_map<obs_sceneitem_t *, OBSSceneItem> SceneItemMap;
+	typedef std::function<void(SceneItemMap &)> UndoOperation;
+	// Given the result of a successful request, returns the operation which reverts it
+	typedef std::function<UndoOperation(const RequestResult &)> UndoRecorder;
+
+	// Read-only requests and requests which can be reverted are supported
+	static bool IsSupportedRequest(const std::string &requestType);
+
+	// Processes a request, recording how to revert it if it succeeds
+	RequestResult ProcessRequest(RequestHandler &requestHandler, const Request &request);
+	// Reverts all recorded requests, most recent first
+	void Rollback();
+
+private:
+	std::vector<UndoOperation> _undoOperations;
+};
@@ -17,11 +17,15 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
+#include <cerrno>
+
 #ifdef PLUGIN_TESTS
 #include <util/profiler.hpp>
 #endif
 
 #include "RequestHandler.h"
+#include "../eventhandler/EventHandler.h"
 
 const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_handlerMap{
 	// General
@@ -33,10 +37,20 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 	{"TriggerHotkeyByName", &RequestHandler::TriggerHotkeyByName},
 	{"TriggerHotkeyByKeySequence", &RequestHandler::TriggerHotkeyByKeySequence},
 	{"Sleep", &RequestHandler::Sleep},
+	{"CreateRequestBatchTemplate", &RequestHandler::CreateRequestBatchTemplate},
+	{"RemoveRequestBatchTemplate", &RequestHandler::RemoveRequestBatchTemplate},
+	{"CallRequestBatchTemplate", &RequestHandler::CallRequestBatchTemplate},
+	{"GetStateSnapshot", &RequestHandler::GetStateSnapshot},
+	{"StopAnimation", &RequestHandler::StopAnimation},
+	{"GetFrameClock", &RequestHandler::GetFrameClock},
+	{"ScheduleRequestBatch", &RequestHandler::ScheduleRequestBatch},
+	{"CancelScheduledRequestBatch", &RequestHandler::CancelScheduledRequestBatch},
 
 	// Config
 	{"GetPersistentData", &RequestHandler::GetPersistentData},
 	{"SetPersistentData", &RequestHandler::SetPersistentData},
+	{"CompareAndSetPersistentData", &RequestHandler::CompareAndSetPersistentData},
+	{"IncrementPersistentData", &RequestHandler::IncrementPersistentData},
 	{"GetSceneCollectionList", &RequestHandler::GetSceneCollectionList},
 	{"SetCurrentSceneCollection", &RequestHandler::SetCurrentSceneCollection},
 	{"CreateSceneCollection", &RequestHandler::CreateSceneCollection},
@@ -60,6 +74,8 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 	{"GetSourceActive", &RequestHandler::GetSourceActive},
 	{"GetSourceScreenshot", &RequestHandler::GetSourceScreenshot},
 	{"SaveSourceScreenshot", &RequestHandler::SaveSourceScreenshot},
+	{"StartSourceScreenshotStream", &RequestHandler::StartSourceScreenshotStream},
+	{"StopSourceScreenshotStream", &RequestHandler::StopSourceScreenshotStream},
 	{"GetSourcePrivateSettings", &RequestHandler::GetSourcePrivateSettings},
 	{"SetSourcePrivateSettings", &RequestHandler::SetSourcePrivateSettings},
 
@@ -91,6 +107,7 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 	{"ToggleInputMute", &RequestHandler::ToggleInputMute},
 	{"GetInputVolume", &RequestHandler::GetInputVolume},
 	{"SetInputVolume", &RequestHandler::SetInputVolume},
+	{"FadeInputVolume", &RequestHandler::FadeInputVolume},
 	{"GetInputAudioBalance", &RequestHandler::GetInputAudioBalance},
 	{"SetInputAudioBalance", &RequestHandler::SetInputAudioBalance},
 	{"GetInputAudioSyncOffset", &RequestHandler::GetInputAudioSyncOffset},
@@ -99,6 +116,7 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 	{"SetInputAudioMonitorType", &RequestHandler::SetInputAudioMonitorType},
 	{"GetInputAudioTracks", &RequestHandler::GetInputAudioTracks},
 	{"SetInputAudioTracks", &RequestHandler::SetInputAudioTracks},
+	{"GetInputAudioStates", &RequestHandler::GetInputAudioStates},
 	{"GetInputDeinterlaceMode", &RequestHandler::GetInputDeinterlaceMode},
 	{"SetInputDeinterlaceMode", &RequestHandler::SetInputDeinterlaceMode},
 	{"GetInputDeinterlaceFieldOrder", &RequestHandler::GetInputDeinterlaceFieldOrder},
@@ -116,6 +134,7 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 	{"GetCurrentSceneTransitionCursor", &RequestHandler::GetCurrentSceneTransitionCursor},
 	{"TriggerStudioModeTransition", &RequestHandler::TriggerStudioModeTransition},
 	{"SetTBarPosition", &RequestHandler::SetTBarPosition},
+	{"AnimateTBarPosition", &RequestHandler::AnimateTBarPosition},
 
 	// Filters
 	{"GetSourceFilterKindList", &RequestHandler::GetSourceFilterKindList},
@@ -139,6 +158,9 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 	{"DuplicateSceneItem", &RequestHandler::DuplicateSceneItem},
 	{"GetSceneItemTransform", &RequestHandler::GetSceneItemTransform},
 	{"SetSceneItemTransform", &RequestHandler::SetSceneItemTransform},
+	{"GetSceneItemTransforms", &RequestHandler::GetSceneItemTransforms},
+	{"SetSceneItemTransforms", &RequestHandler::SetSceneItemTransforms},
+	{"StartSceneItemAnimation", &RequestHandler::StartSceneItemAnimation},
 	{"GetSceneItemEnabled", &RequestHandler::GetSceneItemEnabled},
 	{"SetSceneItemEnabled", &RequestHandler::SetSceneItemEnabled},
 	{"GetSceneItemLocked", &RequestHandler::GetSceneItemLocked},
@@ -237,3 +259,151 @@ std::vector<std::string> RequestHandler::GetRequestList()
 
 	return ret;
 }
+
+ResponseCache RequestHandler::_responseCache;
+
+std::string RequestHandler::GetETag(const std::string &requestType, const std::string &resourceId,
+				    const std::vector<std::string> &resourceKeys, const std::string &untrackedState)
+{
+	auto eventHandler = GetEventHandler();
+	if (!eventHandler)
+		return "";
+
+	std::string tag = requestType + "|" + resourceId;
+	for (auto &resourceKey : resourceKeys)
+		tag += "|" + std::to_string(eventHandler->GetResourceGeneration(resourceKey));
+	tag += "|" + untrackedState;
+
+	char etag[17];
+	snprintf(etag, sizeof(etag), "%016llx", (unsigned long long)std::hash<std::string>{}(tag));
+	return etag;
+}
+
+bool RequestHandler::CheckETag(const Request &request, const std::string &etag, bool &notModified,
+			       RequestStatus::RequestStatus &statusCode, std::string &comment)
+{
+	notModified = false;
+	if (!request.Contains("ifNoneMatch"))
+		return true;
+
+	if (!request.ValidateOptionalString("ifNoneMatch", statusCode, comment))
+		return false;
+
+	notModified = !etag.empty() && request.RequestData["ifNoneMatch"] == etag;
+	return true;
+}
+
+// Every field of a cached response must either change its ETag through a resource generation, or be passed to `GetETag` as
+// untracked state. Otherwise its clients would be served stale data.
+ResponseCache::Payload RequestHandler::GetCachedResponse(const Request &request, const std::string &resourceId,
+							 const std::string &etag)
+{
+	return _responseCache.Get(request.RequestType, resourceId, etag);
+}
+
+ResponseCache::Payload RequestHandler::CacheResponse(const Request &request, const std::string &resourceId,
+						     const std::string &etag, json responseData)
+{
+	return _responseCache.Put(request.RequestType, resourceId, etag, std::move(responseData));
+}
+
+bool RequestHandler::ValidatePage(const Request &request, size_t &pageOffset, size_t &pageSize,
+				  RequestStatus::RequestStatus &statusCode, std::string &comment)
+{
+	pageOffset = 0;
+	pageSize = 0;
+
+	if (request.Contains("pageSize")) {
+		if (!request.ValidateOptionalNumber("pageSize", statusCode, comment, 1))
+			return false;
+
+		pageSize = request.RequestData["pageSize"];
+	}
+
+	if (request.Contains("pageCursor")) {
+		if (!pageSize) {
+			statusCode = RequestStatus::MissingRequestField;
+			comment = "The field `pageSize` must be specified when using `pageCursor`.";
+			return false;
+		}
+
+		if (!request.ValidateOptionalString("pageCursor", statusCode, comment))
+			return false;
+
+		// Cursors are opaque to clients, but are currently just the offset of the next page
+		// strtoull would also accept signs and leading whitespace, so only plain digits are let through
+		const std::string &pageCursor = request.RequestData["pageCursor"].get_ref<const std::string &>();
+		bool isDigits = !pageCursor.empty() &&
+				std::all_of(pageCursor.begin(), pageCursor.end(), [](char c) { return c >= '0' && c <= '9'; });
+		errno = 0;
+		if (isDigits)
+			pageOffset = strtoull(pageCursor.c_str(), nullptr, 10);
+		if (!isDigits || errno == ERANGE) {
+			statusCode = RequestStatus::InvalidRequestField;
+			comment = "The field `pageCursor` is not a cursor returned by a previous request.";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void RequestHandler::Paginate(json &responseData, const std::string &listKey, size_t pageOffset, size_t pageSize)
+{
+	if (!pageSize)
+		return;
+
+	json &list = responseData[listKey];
+	size_t listSize = list.size();
+	size_t pageBegin = std::min(pageOffset, listSize);
+	size_t pageEnd = std::min(pageBegin + pageSize, listSize);
+
+	list.erase(list.begin() + pageEnd, list.end());
+	list.erase(list.begin(), list.begin() + pageBegin);
+
+	if (pageEnd < listSize)
+		responseData["nextPageCursor"] = std::to_string(pageEnd);
+	else
+		responseData["nextPageCursor"] = nullptr;
+}
+
+json RequestHandler::GetPage(const json &responseData, const std::string &listKey, size_t pageOffset, size_t pageSize)
+{
+	if (!pageSize)
+		return responseData;
+
+	json page = json::object();
+	for (auto &[key, value] : responseData.items())
+		if (key != listKey)
+			page[key] = value;
+
+	const json &list = responseData[listKey];
+	size_t listSize = list.size();
+	size_t pageBegin = std::min(pageOffset, listSize);
+	size_t pageEnd = std::min(pageBegin + pageSize, listSize);
+
+	page[listKey] = json(list.begin() + pageBegin, list.begin() + pageEnd);
+
+	if (pageEnd < listSize)
+		page["nextPageCursor"] = std::to_string(pageEnd);
+	else
+		page["nextPageCursor"] = nullptr;
+
+	return page;
+}
+
+bool RequestHandler::ValidateAnimation(const Request &request, uint64_t &durationMs, AnimationEasing::AnimationEasing &easing,
+				       RequestStatus::RequestStatus &statusCode, std::string &comment)
+{
+	if (!(request.ValidateNumber("duration", statusCode, comment, 0, 3600000) &&
+	      request.ValidateOptionalNumber("easing", statusCode, comment, 0, AnimationEasing::EaseInOut)))
+		return false;
+
+	durationMs = request.RequestData["duration"];
+
+	easing = AnimationEasing::Linear;
+	if (request.Contains("easing"))
+		easing = (AnimationEasing::AnimationEasing)request.RequestData["easing"].get<uint8_t>();
+
+	return true;
+}
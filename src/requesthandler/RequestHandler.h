@@ -27,6 +27,8 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "rpc/RequestResult.h"
 #include "types/RequestStatus.h"
 #include "types/RequestBatchExecutionType.h"
+#include "types/AnimationEasing.h"
+#include "ResponseCache.h"
 #include "../websocketserver/rpc/WebSocketSession.h"
 #include "../obs-websocket.h"
 #include "../utils/Obs.h"
@@ -52,10 +54,20 @@ private:
 	RequestResult TriggerHotkeyByName(const Request &);
 	RequestResult TriggerHotkeyByKeySequence(const Request &);
 	RequestResult Sleep(const Request &);
+	RequestResult CreateRequestBatchTemplate(const Request &);
+	RequestResult RemoveRequestBatchTemplate(const Request &);
+	RequestResult CallRequestBatchTemplate(const Request &);
+	RequestResult GetStateSnapshot(const Request &);
+	RequestResult StopAnimation(const Request &);
+	RequestResult GetFrameClock(const Request &);
+	RequestResult ScheduleRequestBatch(const Request &);
+	RequestResult CancelScheduledRequestBatch(const Request &);
 
 	// Config
 	RequestResult GetPersistentData(const Request &);
 	RequestResult SetPersistentData(const Request &);
+	RequestResult CompareAndSetPersistentData(const Request &);
+	RequestResult IncrementPersistentData(const Request &);
 	RequestResult GetSceneCollectionList(const Request &);
 	RequestResult SetCurrentSceneCollection(const Request &);
 	RequestResult CreateSceneCollection(const Request &);
@@ -79,6 +91,8 @@ private:
 	RequestResult GetSourceActive(const Request &);
 	RequestResult GetSourceScreenshot(const Request &);
 	RequestResult SaveSourceScreenshot(const Request &);
+	RequestResult StartSourceScreenshotStream(const Request &);
+	RequestResult StopSourceScreenshotStream(const Request &);
 	RequestResult GetSourcePrivateSettings(const Request &);
 	RequestResult SetSourcePrivateSettings(const Request &);
 
@@ -110,6 +124,7 @@ private:
 	RequestResult ToggleInputMute(const Request &);
 	RequestResult GetInputVolume(const Request &);
 	RequestResult SetInputVolume(const Request &);
+	RequestResult FadeInputVolume(const Request &);
 	RequestResult GetInputAudioBalance(const Request &);
 	RequestResult SetInputAudioBalance(const Request &);
 	RequestResult GetInputAudioSyncOffset(const Request &);
@@ -118,6 +133,7 @@ private:
 	RequestResult SetInputAudioMonitorType(const Request &);
 	RequestResult GetInputAudioTracks(const Request &);
 	RequestResult SetInputAudioTracks(const Request &);
+	RequestResult GetInputAudioStates(const Request &);
 	RequestResult GetInputDeinterlaceMode(const Request &);
 	RequestResult SetInputDeinterlaceMode(const Request &);
 	RequestResult GetInputDeinterlaceFieldOrder(const Request &);
@@ -135,6 +151,7 @@ private:
 	RequestResult GetCurrentSceneTransitionCursor(const Request &);
 	RequestResult TriggerStudioModeTransition(const Request &);
 	RequestResult SetTBarPosition(const Request &);
+	RequestResult AnimateTBarPosition(const Request &);
 
 	// Filters
 	RequestResult GetSourceFilterKindList(const Request &);
@@ -158,6 +175,9 @@ private:
 	RequestResult DuplicateSceneItem(const Request &);
 	RequestResult GetSceneItemTransform(const Request &);
 	RequestResult SetSceneItemTransform(const Request &);
+	RequestResult GetSceneItemTransforms(const Request &);
+	RequestResult SetSceneItemTransforms(const Request &);
+	RequestResult StartSceneItemAnimation(const Request &);
 	RequestResult GetSceneItemEnabled(const Request &);
 	RequestResult SetSceneItemEnabled(const Request &);
 	RequestResult GetSceneItemLocked(const Request &);
@@ -222,6 +242,33 @@ private:
 	RequestResult OpenVideoMixProjector(const Request &);
 	RequestResult OpenSourceProjector(const Request &);
 
+	// ETags of read requests, created from the generations of the resources which a response is built from. State which
+	// is changed without emitting an event has no generation, so it must be passed as `untrackedState` instead
+	static std::string GetETag(const std::string &requestType, const std::string &resourceId,
+				   const std::vector<std::string> &resourceKeys, const std::string &untrackedState = "");
+	// Returns false if `ifNoneMatch` is invalid. `notModified` is set if it is equal to the current ETag
+	static bool CheckETag(const Request &request, const std::string &etag, bool &notModified,
+			      RequestStatus::RequestStatus &statusCode, std::string &comment);
+	// Shared response cache of read requests, see `ResponseCache.h`
+	static ResponseCache::Payload GetCachedResponse(const Request &request, const std::string &resourceId,
+							const std::string &etag);
+	static ResponseCache::Payload CacheResponse(const Request &request, const std::string &resourceId, const std::string &etag,
+						    json responseData);
+	// Cursor pagination of list requests, using the optional `pageSize` and `pageCursor` fields. `pageSize` is 0 if not paginated
+	static bool ValidatePage(const Request &request, size_t &pageOffset, size_t &pageSize,
+				 RequestStatus::RequestStatus &statusCode, std::string &comment);
+	// Removes the items of `responseData[listKey]` outside of the page, and sets `nextPageCursor`
+	static void Paginate(json &responseData, const std::string &listKey, size_t pageOffset, size_t pageSize);
+	// Same as `Paginate`, but copies the page out of a cached response instead of modifying it
+	static json GetPage(const json &responseData, const std::string &listKey, size_t pageOffset, size_t pageSize);
+	// Builds the requests of a stored batch, validating them for its execution type
+	static bool BuildRequestBatchTemplate(const json &requestsJson, RequestBatchTemplate &batchTemplate,
+					      RequestStatus::RequestStatus &statusCode, std::string &comment);
+	// Timing of animation requests, using the `duration` and optional `easing` fields
+	static bool ValidateAnimation(const Request &request, uint64_t &durationMs, AnimationEasing::AnimationEasing &easing,
+				      RequestStatus::RequestStatus &statusCode, std::string &comment);
+
 	SessionPtr _session;
 	static const std::unordered_map<std::string, RequestMethodHandler> _handlerMap;
+	static ResponseCache _responseCache;
 };
@@ -21,12 +21,13 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/config-file.h>
 
 #include "RequestHandler.h"
-
-#define GLOBAL_PERSISTENT_DATA_FILE_NAME "persistent_data.json"
+#include "PersistentDataStore.h"
 
 /**
  * Gets the value of a "slot" from the selected persistent data realm.
  *
+ * Persistent data is kept in memory, so this does not access the disk after the first use of a realm.
+ *
  * @requestField realm    | String | The data realm to select. `OBS_WEBSOCKET_DATA_REALM_GLOBAL` or `OBS_WEBSOCKET_DATA_REALM_PROFILE`
  * @requestField slotName | String | The name of the slot to retrieve data from
  *
@@ -49,28 +50,26 @@ RequestResult RequestHandler::GetPersistentData(const Request &request)
 	std::string realm = request.RequestData["realm"];
 	std::string slotName = request.RequestData["slotName"];
 
-	std::string persistentDataPath;
-	if (realm == "OBS_WEBSOCKET_DATA_REALM_GLOBAL")
-		persistentDataPath = Utils::Obs::StringHelper::GetModuleConfigPath(GLOBAL_PERSISTENT_DATA_FILE_NAME);
-	else if (realm == "OBS_WEBSOCKET_DATA_REALM_PROFILE")
-		persistentDataPath = Utils::Obs::StringHelper::GetCurrentProfilePath() + "/obsWebSocketPersistentData.json";
-	else
+	PersistentDataStore::Realm persistentDataRealm;
+	if (!PersistentDataStore::GetRealm(realm, persistentDataRealm))
 		return RequestResult::Error(RequestStatus::ResourceNotFound,
 					    "You have specified an invalid persistent data realm.");
 
-	json responseData;
-	json persistentData;
-	if (Utils::Json::GetJsonFileContent(persistentDataPath, persistentData) && persistentData.contains(slotName))
-		responseData["slotValue"] = persistentData[slotName];
-	else
-		responseData["slotValue"] = nullptr;
+	auto persistentDataStore = GetPersistentDataStore();
+	if (!persistentDataStore)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "The persistent data store is not available.");
 
+	json responseData;
+	responseData["slotValue"] = persistentDataStore->Get(persistentDataRealm, slotName);
 	return RequestResult::Success(responseData);
 }
 
 /**
  * Sets the value of a "slot" from the selected persistent data realm.
  *
+ * The value is applied in memory immediately, and written to disk in the background.
+ * Changes made while a write is in progress are combined into the next write. Pending writes are completed when the profile changes or OBS exits.
+ *
  * @requestField realm     | String | The data realm to select. `OBS_WEBSOCKET_DATA_REALM_GLOBAL` or `OBS_WEBSOCKET_DATA_REALM_PROFILE`
  * @requestField slotName  | String | The name of the slot to retrieve data from
  * @requestField slotValue | Any    | The value to apply to the slot
@@ -94,25 +93,134 @@ RequestResult RequestHandler::SetPersistentData(const Request &request)
 	std::string slotName = request.RequestData["slotName"];
 	json slotValue = request.RequestData["slotValue"];
 
-	std::string persistentDataPath;
-	if (realm == "OBS_WEBSOCKET_DATA_REALM_GLOBAL")
-		persistentDataPath = Utils::Obs::StringHelper::GetModuleConfigPath(GLOBAL_PERSISTENT_DATA_FILE_NAME);
-	else if (realm == "OBS_WEBSOCKET_DATA_REALM_PROFILE")
-		persistentDataPath = Utils::Obs::StringHelper::GetCurrentProfilePath() + "/obsWebSocketPersistentData.json";
-	else
+	PersistentDataStore::Realm persistentDataRealm;
+	if (!PersistentDataStore::GetRealm(realm, persistentDataRealm))
 		return RequestResult::Error(RequestStatus::ResourceNotFound,
 					    "You have specified an invalid persistent data realm.");
 
-	json persistentData;
-	Utils::Json::GetJsonFileContent(persistentDataPath, persistentData);
-	persistentData[slotName] = slotValue;
-	if (!Utils::Json::SetJsonFileContent(persistentDataPath, persistentData))
-		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
-					    "Unable to write persistent data. No permissions?");
+	auto persistentDataStore = GetPersistentDataStore();
+	if (!persistentDataStore)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "The persistent data store is not available.");
 
+	persistentDataStore->Set(persistentDataRealm, slotName, std::move(slotValue));
 	return RequestResult::Success();
 }
 
+/**
+ * Sets the value of a "slot" from the selected persistent data realm, only if it currently has the expected value.
+ *
+ * The comparison and the change are atomic, so this can be used to implement locks shared between clients.
+ *
+ * @requestField realm          | String | The data realm to select. `OBS_WEBSOCKET_DATA_REALM_GLOBAL` or `OBS_WEBSOCKET_DATA_REALM_PROFILE`
+ * @requestField slotName       | String | The name of the slot to change
+ * @requestField ?expectedValue | Any    | The value the slot must currently have | `null`, meaning the slot must not be set
+ * @requestField slotValue      | Any    | The value to apply to the slot
+ *
+ * @responseField valueSet  | Boolean | Whether the slot had the expected value and was changed
+ * @responseField slotValue | Any     | Value of the slot after the operation. `null` if not set
+ *
+ * @requestType CompareAndSetPersistentData
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category config
+ * @api requests
+ */
+RequestResult RequestHandler::CompareAndSetPersistentData(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!(request.ValidateString("realm", statusCode, comment) && request.ValidateString("slotName", statusCode, comment) &&
+	      request.ValidateBasic("slotValue", statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	std::string realm = request.RequestData["realm"];
+	std::string slotName = request.RequestData["slotName"];
+	json expectedValue = request.Contains("expectedValue") ? request.RequestData["expectedValue"] : json(nullptr);
+	json slotValue = request.RequestData["slotValue"];
+
+	PersistentDataStore::Realm persistentDataRealm;
+	if (!PersistentDataStore::GetRealm(realm, persistentDataRealm))
+		return RequestResult::Error(RequestStatus::ResourceNotFound,
+					    "You have specified an invalid persistent data realm.");
+
+	auto persistentDataStore = GetPersistentDataStore();
+	if (!persistentDataStore)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "The persistent data store is not available.");
+
+	json currentValue;
+	bool valueSet = persistentDataStore->CompareAndSet(persistentDataRealm, slotName, expectedValue, std::move(slotValue),
+							   currentValue);
+
+	json responseData;
+	responseData["valueSet"] = valueSet;
+	responseData["slotValue"] = currentValue;
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Adds to the number in a "slot" from the selected persistent data realm.
+ *
+ * The increment is atomic, so this can be used to implement counters shared between clients.
+ * A slot which is not set counts as 0. The result is an integer if both the slot value and `incrementBy` are integers.
+ * An integer increment which does not fit in 64 bits fails and leaves the slot unchanged.
+ *
+ * @requestField realm        | String | The data realm to select. `OBS_WEBSOCKET_DATA_REALM_GLOBAL` or `OBS_WEBSOCKET_DATA_REALM_PROFILE`
+ * @requestField slotName     | String | The name of the slot to increment
+ * @requestField ?incrementBy | Number | The amount to add to the slot. May be negative | None | 1
+ *
+ * @responseField slotValue | Number | Value of the slot after the increment
+ *
+ * @requestType IncrementPersistentData
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category config
+ * @api requests
+ */
+RequestResult RequestHandler::IncrementPersistentData(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!(request.ValidateString("realm", statusCode, comment) && request.ValidateString("slotName", statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	std::string realm = request.RequestData["realm"];
+	std::string slotName = request.RequestData["slotName"];
+
+	json incrementBy = 1;
+	if (request.Contains("incrementBy")) {
+		if (!request.ValidateOptionalNumber("incrementBy", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		incrementBy = request.RequestData["incrementBy"];
+	}
+
+	PersistentDataStore::Realm persistentDataRealm;
+	if (!PersistentDataStore::GetRealm(realm, persistentDataRealm))
+		return RequestResult::Error(RequestStatus::ResourceNotFound,
+					    "You have specified an invalid persistent data realm.");
+
+	auto persistentDataStore = GetPersistentDataStore();
+	if (!persistentDataStore)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "The persistent data store is not available.");
+
+	json slotValue;
+	switch (persistentDataStore->Increment(persistentDataRealm, slotName, incrementBy, slotValue)) {
+	case PersistentDataStore::NotANumber:
+		return RequestResult::Error(RequestStatus::InvalidResourceState, "The slot does not hold a number.");
+	case PersistentDataStore::Overflowed:
+		return RequestResult::Error(RequestStatus::RequestFieldOutOfRange,
+					    "The increment would overflow the integer value of the slot.");
+	default:
+		break;
+	}
+
+	json responseData;
+	responseData["slotValue"] = slotValue;
+	return RequestResult::Success(responseData);
+}
+
 /**
  * Gets an array of all scene collections
  *
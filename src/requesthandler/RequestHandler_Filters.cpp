@@ -19,6 +19,11 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include "RequestHandler.h"
 
+// Fields of `GetSourceFilterList` which may be selected with `responseFields`
+static const std::unordered_set<std::string> sourceFilterListFields = {
+	"filterEnabled", "filterIndex", "filterKind", "filterName", "filterSettings",
+};
+
 /**
  * Gets an array of all available source filter kinds.
  *
@@ -43,11 +48,15 @@ RequestResult RequestHandler::GetSourceFilterKindList(const Request &)
 /**
  * Gets an array of all of a source's filters.
  *
- * @requestField ?canvasUuid | String | UUID of the canvas the source is in, if using the sourceName field
- * @requestField ?sourceName | String | Name of the source
- * @requestField ?sourceUuid | String | UUID of the source
+ * @requestField ?canvasUuid     | String        | UUID of the canvas the source is in, if using the sourceName field
+ * @requestField ?sourceName     | String        | Name of the source
+ * @requestField ?sourceUuid     | String        | UUID of the source
+ * @requestField ?ifNoneMatch    | String        | ETag of a previous response. If the filters have not changed since, only `etag` and `notModified` are returned
+ * @requestField ?responseFields | Array<String> | Fields of each filter to return. Unselected fields (such as `filterSettings`) are not fetched | All fields
  *
- * @responseField filters | Array<Object> | Array of filters
+ * @responseField etag        | String        | ETag of the filter list, to be used as `ifNoneMatch` of a later request
+ * @responseField notModified | Boolean       | Only returned (as `true`) if `ifNoneMatch` is equal to the current ETag
+ * @responseField filters     | Array<Object> | Array of filters
  *
  * @requestType GetSourceFilterList
  * @complexity 2
@@ -61,11 +70,27 @@ RequestResult RequestHandler::GetSourceFilterList(const Request &request)
 	RequestStatus::RequestStatus statusCode;
 	std::string comment;
 	OBSSourceAutoRelease source = request.AcquireSource("canvasUuid", "sourceName", "sourceUuid", statusCode, comment);
-	if (!source)
+	Utils::Obs::FieldSelector fields;
+	if (!(source && request.ValidateResponseFields(sourceFilterListFields, fields, statusCode, comment)))
 		return RequestResult::Error(statusCode, comment);
 
+	// Filter events identify their source by name
+	std::string resourceId = std::string(obs_source_get_uuid(source)) + "|" + fields.ToString();
+	std::string etag = GetETag(request.RequestType, resourceId, {std::string("filters:") + obs_source_get_name(source)});
+	bool notModified;
+	if (!CheckETag(request, etag, notModified, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+	if (notModified)
+		return RequestResult::NotModified(etag);
+
+	ResponseCache::Payload cachedResponse = GetCachedResponse(request, resourceId, etag);
+	if (cachedResponse)
+		return RequestResult::Success(*cachedResponse);
+
 	json responseData;
-	responseData["filters"] = Utils::Obs::ArrayHelper::GetSourceFilterList(source);
+	responseData["etag"] = etag;
+	responseData["filters"] = Utils::Obs::ArrayHelper::GetSourceFilterList(source, fields);
+	CacheResponse(request, resourceId, etag, responseData);
 
 	return RequestResult::Success(responseData);
 }
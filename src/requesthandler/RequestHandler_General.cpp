@@ -17,14 +17,19 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
-#include <QImageWriter>
 #include <QSysInfo>
 
 #include "RequestHandler.h"
+#include "RequestBatchHandler.h"
+#include "RequestBatchTransaction.h"
+#include "AnimationManager.h"
+#include "RequestScheduler.h"
 #include "../websocketserver/WebSocketServer.h"
+#include "../eventhandler/EventHandler.h"
 #include "../eventhandler/types/EventSubscription.h"
 #include "../WebSocketApi.h"
 #include "../obs-websocket.h"
+#include "../utils/Image.h"
 
 /**
  * Gets data about the current plugin and RPC version.
@@ -52,12 +57,7 @@ RequestResult RequestHandler::GetVersion(const Request &)
 	responseData["rpcVersion"] = OBS_WEBSOCKET_RPC_VERSION;
 	responseData["availableRequests"] = GetRequestList();
 
-	QList<QByteArray> imageWriterFormats = QImageWriter::supportedImageFormats();
-	std::vector<std::string> supportedImageFormats;
-	for (const QByteArray &format : imageWriterFormats) {
-		supportedImageFormats.push_back(format.toStdString());
-	}
-	responseData["supportedImageFormats"] = supportedImageFormats;
+	responseData["supportedImageFormats"] = Utils::Image::GetSupportedFormats();
 
 	responseData["platform"] = QSysInfo::productType().toStdString();
 	responseData["platformDescription"] = QSysInfo::prettyProductName().toStdString();
@@ -79,6 +79,9 @@ RequestResult RequestHandler::GetVersion(const Request &)
  * @responseField outputTotalFrames                | Number | Total number of frames outputted by the output thread
  * @responseField webSocketSessionIncomingMessages | Number | Total number of messages received by obs-websocket from the client
  * @responseField webSocketSessionOutgoingMessages | Number | Total number of messages sent by obs-websocket to the client
+ * @responseField responseCacheHits                | Number | Number of list requests which were answered from the response cache, across all clients
+ * @responseField responseCacheMisses              | Number | Number of list requests which had to build their response, across all clients
+ * @responseField imageEncoderStats                | Object | Screenshot encoding statistics by image format. Each contains `encodedImages`, `totalEncodeTime` and `averageEncodeTime` (milliseconds), and `totalEncodedBytes`
  *
  * @requestType GetStats
  * @complexity 2
@@ -99,6 +102,10 @@ RequestResult RequestHandler::GetStats(const Request &)
 		responseData["webSocketSessionOutgoingMessages"] = nullptr;
 	}
 
+	responseData["responseCacheHits"] = _responseCache.Hits();
+	responseData["responseCacheMisses"] = _responseCache.Misses();
+	responseData["imageEncoderStats"] = Utils::Image::GetEncoderStats();
+
 	return RequestResult::Success(responseData);
 }
 
@@ -215,7 +222,11 @@ RequestResult RequestHandler::CallVendorRequest(const Request &request)
  *
  * Note: Hotkey functionality in obs-websocket comes as-is, and we do not guarantee support if things are broken. In 9/10 usages of hotkey requests, there exists a better, more reliable method via other requests.
  *
- * @responseField hotkeys | Array<String> | Array of hotkey names
+ * @requestField ?pageSize   | Number | Maximum number of hotkeys to return. Enables pagination | >= 1 | Not paginated
+ * @requestField ?pageCursor | String | `nextPageCursor` of the previous page. Requires `pageSize` | First page
+ *
+ * @responseField hotkeys        | Array<String> | Array of hotkey names
+ * @responseField nextPageCursor | String        | Only returned if paginated. Cursor of the next page, or `null` if this is the last page
  *
  * @requestType GetHotkeyList
  * @complexity 4
@@ -224,10 +235,17 @@ RequestResult RequestHandler::CallVendorRequest(const Request &request)
  * @category general
  * @api requests
  */
-RequestResult RequestHandler::GetHotkeyList(const Request &)
+RequestResult RequestHandler::GetHotkeyList(const Request &request)
 {
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	size_t pageOffset, pageSize;
+	if (!ValidatePage(request, pageOffset, pageSize, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
 	json responseData;
 	responseData["hotkeys"] = Utils::Obs::ArrayHelper::GetHotkeyNameList();
+	Paginate(responseData, "hotkeys", pageOffset, pageSize);
 	return RequestResult::Success(responseData);
 }
 
@@ -372,3 +390,511 @@ RequestResult RequestHandler::Sleep(const Request &request)
 		return RequestResult::Error(RequestStatus::UnsupportedRequestBatchExecutionType);
 	}
 }
+
+// Validates every request up front, so that executing the batch later only has to apply variables.
+// Uses the execution type and atomic flag of the template.
+bool RequestHandler::BuildRequestBatchTemplate(const json &requestsJson, RequestBatchTemplate &batchTemplate,
+					       RequestStatus::RequestStatus &statusCode, std::string &comment)
+{
+	auto executionType = batchTemplate.ExecutionType;
+
+	size_t i = 0;
+	for (auto &requestJson : requestsJson) {
+		std::string index = std::to_string(i++);
+
+		if (!requestJson.is_object()) {
+			statusCode = RequestStatus::InvalidRequestFieldType;
+			comment = "The request at index " + index + " is not an object.";
+			return false;
+		}
+
+		if (!requestJson.contains("requestType") || !requestJson["requestType"].is_string()) {
+			statusCode = RequestStatus::InvalidRequestFieldType;
+			comment = "The `requestType` of the request at index " + index + " is not a string.";
+			return false;
+		}
+
+		std::string requestType = requestJson["requestType"];
+		if (!_handlerMap.count(requestType)) {
+			statusCode = RequestStatus::UnknownRequestType;
+			comment = "The request type of the request at index " + index + " is not valid.";
+			return false;
+		}
+
+		if (requestType == "CallRequestBatchTemplate") {
+			statusCode = RequestStatus::InvalidRequestField;
+			comment = "Stored request batches may not call templates.";
+			return false;
+		}
+
+		if (batchTemplate.Atomic && !RequestBatchTransaction::IsSupportedRequest(requestType)) {
+			statusCode = RequestStatus::InvalidRequestField;
+			comment = "The request at index " + index +
+				  " cannot be rolled back, so it is not supported in atomic batches.";
+			return false;
+		}
+
+		json requestData = requestJson.contains("requestData") ? requestJson["requestData"] : json();
+		if (!requestData.is_object() && !requestData.is_null()) {
+			statusCode = RequestStatus::InvalidRequestFieldType;
+			comment = "The `requestData` of the request at index " + index + " is not an object.";
+			return false;
+		}
+
+		json inputVariables = requestJson.contains("inputVariables") ? requestJson["inputVariables"] : json();
+		json outputVariables = requestJson.contains("outputVariables") ? requestJson["outputVariables"] : json();
+		if (executionType == RequestBatchExecutionType::Parallel &&
+		    (!inputVariables.is_null() || !outputVariables.is_null())) {
+			statusCode = RequestStatus::InvalidRequestField;
+			comment = "Variables are not supported in Parallel mode.";
+			return false;
+		}
+
+		json condition = requestJson.contains("condition") ? requestJson["condition"] : json();
+		json repeat = requestJson.contains("repeat") ? requestJson["repeat"] : json();
+		if (executionType == RequestBatchExecutionType::Parallel && (!condition.is_null() || !repeat.is_null())) {
+			statusCode = RequestStatus::InvalidRequestField;
+			comment = "Request conditions and repeats are not supported in Parallel mode.";
+			return false;
+		}
+
+		batchTemplate.Requests.emplace_back(requestType, requestData, executionType, inputVariables, outputVariables,
+						    condition, repeat);
+		batchTemplate.RequestIds.push_back(requestJson.contains("requestId") ? requestJson["requestId"] : json());
+	}
+
+	return true;
+}
+
+/**
+ * Creates a request batch template, which is validated and stored by obs-websocket so that it can be executed later using `CallRequestBatchTemplate`.
+ *
+ * Requests in the `requests` array follow the same structure as the `RequestBatch` requests array, including `inputVariables`, `outputVariables`, `condition` and `repeat`.
+ * Values can be passed to a template at call time by binding request fields to batch variables with `inputVariables`.
+ *
+ * Session templates are removed when the session disconnects. Global templates are available to all sessions until OBS is closed.
+ * If a template with the same name already exists in the selected scope, it is replaced.
+ * A maximum of 256 global templates may exist at once.
+ *
+ * @requestField templateName    | String        | Name of the template to create
+ * @requestField requests        | Array<Object> | Array of requests to store in the template
+ * @requestField ?executionType  | Number        | `RequestBatchExecutionType` to execute the template with | >= 0, <= 2 | `SerialRealtime`
+ * @requestField ?haltOnFailure  | Boolean       | Whether to halt processing of the template on the first failed request | false
+ * @requestField ?atomic         | Boolean       | Whether to roll back all changes of the template if a request fails. Requires `SerialFrame` | false
+ * @requestField ?globalTemplate | Boolean       | Whether to make the template available to all sessions instead of only the current one | false
+ *
+ * @requestType CreateRequestBatchTemplate
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::CreateRequestBatchTemplate(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!(request.ValidateString("templateName", statusCode, comment) &&
+	      request.ValidateArray("requests", statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	auto executionType = RequestBatchExecutionType::SerialRealtime;
+	if (request.Contains("executionType")) {
+		if (!request.ValidateOptionalNumber("executionType", statusCode, comment, RequestBatchExecutionType::SerialRealtime,
+						    RequestBatchExecutionType::Parallel))
+			return RequestResult::Error(statusCode, comment);
+
+		int8_t requestedExecutionType = request.RequestData["executionType"];
+		executionType = (RequestBatchExecutionType::RequestBatchExecutionType)requestedExecutionType;
+	}
+
+	bool haltOnFailure = false;
+	if (request.Contains("haltOnFailure")) {
+		if (!request.ValidateOptionalBoolean("haltOnFailure", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		haltOnFailure = request.RequestData["haltOnFailure"];
+	}
+
+	bool atomic = false;
+	if (request.Contains("atomic")) {
+		if (!request.ValidateOptionalBoolean("atomic", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		atomic = request.RequestData["atomic"];
+		if (atomic && executionType != RequestBatchExecutionType::SerialFrame)
+			return RequestResult::Error(RequestStatus::UnsupportedRequestBatchExecutionType,
+						    "Atomic request batch templates require the SerialFrame execution type.");
+	}
+
+	bool globalTemplate = !_session;
+	if (request.Contains("globalTemplate")) {
+		if (!request.ValidateOptionalBoolean("globalTemplate", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		globalTemplate = globalTemplate || request.RequestData["globalTemplate"].get<bool>();
+	}
+
+	auto webSocketServer = GetWebSocketServer();
+	if (!webSocketServer)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to create template due to internal error.");
+
+	// The thread pool must support 2 or more threads else parallel requests will deadlock.
+	if (executionType == RequestBatchExecutionType::Parallel && webSocketServer->GetThreadPool()->maxThreadCount() < 2)
+		return RequestResult::Error(RequestStatus::UnsupportedRequestBatchExecutionType,
+					    "Parallel request batch processing is not available on this system due to limited core count.");
+
+	auto batchTemplate = std::make_shared<RequestBatchTemplate>();
+	batchTemplate->ExecutionType = executionType;
+	batchTemplate->HaltOnFailure = haltOnFailure;
+	batchTemplate->Atomic = atomic;
+
+	if (!BuildRequestBatchTemplate(request.RequestData["requests"], *batchTemplate, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
+	std::string templateName = request.RequestData["templateName"];
+	if (globalTemplate) {
+		if (!RequestBatchHandler::SetGlobalTemplate(templateName, batchTemplate))
+			return RequestResult::Error(RequestStatus::NotEnoughResources,
+						    "The maximum number of global templates has been reached.");
+	} else {
+		_session->SetRequestBatchTemplate(templateName, batchTemplate);
+	}
+
+	return RequestResult::Success();
+}
+
+/**
+ * Removes a request batch template.
+ *
+ * @requestField templateName    | String  | Name of the template to remove
+ * @requestField ?globalTemplate | Boolean | Whether to remove the global template instead of the session template | false
+ *
+ * @requestType RemoveRequestBatchTemplate
+ * @complexity 2
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::RemoveRequestBatchTemplate(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!request.ValidateString("templateName", statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
+	bool globalTemplate = !_session;
+	if (request.Contains("globalTemplate")) {
+		if (!request.ValidateOptionalBoolean("globalTemplate", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		globalTemplate = globalTemplate || request.RequestData["globalTemplate"].get<bool>();
+	}
+
+	std::string templateName = request.RequestData["templateName"];
+	bool removed = globalTemplate ? RequestBatchHandler::RemoveGlobalTemplate(templateName)
+				      : _session->RemoveRequestBatchTemplate(templateName);
+	if (!removed)
+		return RequestResult::Error(RequestStatus::ResourceNotFound, "No request batch template was found by that name.");
+
+	return RequestResult::Success();
+}
+
+/**
+ * Executes a request batch template created with `CreateRequestBatchTemplate`.
+ *
+ * Templates stored in the current session take priority over global templates with the same name.
+ * Not available inside of request batches.
+ *
+ * @requestField templateName | String | Name of the template to execute
+ * @requestField ?variables   | Object | Initial batch variables, used by the `inputVariables` of the stored requests | {}
+ *
+ * @responseField results | Array<Object> | Array of request results, in the same format as the `results` of a `RequestBatchResponse`
+ *
+ * @requestType CallRequestBatchTemplate
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::CallRequestBatchTemplate(const Request &request)
+{
+	// Nested batches would block the batch they were called from (and deadlock the graphics thread in `SerialFrame` mode)
+	if (request.ExecutionType != RequestBatchExecutionType::None)
+		return RequestResult::Error(RequestStatus::UnsupportedRequestBatchExecutionType,
+					    "Request batch templates cannot be called from inside of a request batch.");
+
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!request.ValidateString("templateName", statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
+	json variables = json::object();
+	if (request.Contains("variables")) {
+		if (!request.ValidateOptionalObject("variables", statusCode, comment, true))
+			return RequestResult::Error(statusCode, comment);
+
+		variables = request.RequestData["variables"];
+	}
+
+	std::string templateName = request.RequestData["templateName"];
+	RequestBatchTemplatePtr batchTemplate;
+	if (_session)
+		batchTemplate = _session->GetRequestBatchTemplate(templateName);
+	if (!batchTemplate)
+		batchTemplate = RequestBatchHandler::GetGlobalTemplate(templateName);
+	if (!batchTemplate)
+		return RequestResult::Error(RequestStatus::ResourceNotFound, "No request batch template was found by that name.");
+
+	auto webSocketServer = GetWebSocketServer();
+	if (!webSocketServer)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to call template due to internal error.");
+
+	// The template is shared and never modified by processing it, so its requests are used as they are
+	std::vector<RequestResult> results = RequestBatchHandler::ProcessRequestBatch(
+		*webSocketServer->GetThreadPool(), _session, batchTemplate->ExecutionType, batchTemplate->Requests, variables,
+		batchTemplate->HaltOnFailure, batchTemplate->Atomic);
+
+	json responseData;
+	responseData["results"] = RequestBatchHandler::GetResultsJson(*batchTemplate, results);
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Gets a snapshot of the scene graph state: all scenes with their scene items and filters, and all inputs with their filters.
+ *
+ * The snapshot is tagged with a state version, which is incremented by every change to the state.
+ * To keep a mirror of the state, subscribe to `StateDeltas` first, then apply every `StateDelta` event with a
+ * `stateVersion` greater than the one of the snapshot. Deltas should be applied idempotently, as a change which
+ * happened while the snapshot was being created may be both in the snapshot and in a following delta.
+ *
+ * The snapshot is shared between all clients, and is only created again once the state has changed.
+ *
+ * @responseField stateVersion | Number        | State version of the snapshot
+ * @responseField scenes       | Array<Object> | Array of scenes, each with `sceneItems` and `sceneFilters`. Groups have their items in `groupSceneItems`
+ * @responseField inputs       | Array<Object> | Array of inputs, each with `inputFilters`
+ *
+ * @requestType GetStateSnapshot
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::GetStateSnapshot(const Request &)
+{
+	auto eventHandler = GetEventHandler();
+	if (!eventHandler)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to get the state snapshot due to internal error.");
+
+	return RequestResult::Success(eventHandler->GetStateSnapshot());
+}
+
+/**
+ * Stops a running animation, leaving its target in its current state.
+ *
+ * The `AnimationEnded` event is emitted with `cancelled` set to `true`.
+ *
+ * @requestField animationId | Number | ID of the animation to stop | >= 1
+ *
+ * @requestType StopAnimation
+ * @complexity 2
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::StopAnimation(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!request.ValidateNumber("animationId", statusCode, comment, 1))
+		return RequestResult::Error(statusCode, comment);
+
+	auto animationManager = GetAnimationManager();
+	if (!animationManager)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to stop animation due to internal error.");
+
+	uint64_t animationId = request.RequestData["animationId"];
+	if (!animationManager->Stop(animationId))
+		return RequestResult::Error(RequestStatus::ResourceNotFound,
+					    "No running animation was found by the ID of `" + std::to_string(animationId) + "`.");
+
+	return RequestResult::Success();
+}
+
+/**
+ * Gets the clock used to schedule request batches with `ScheduleRequestBatch`.
+ *
+ * @responseField currentFrame     | Number | Number of frames rendered since obs-websocket was loaded
+ * @responseField currentTimestamp | Number | Current time of the OBS clock in nanoseconds
+ * @responseField frameInterval    | Number | Time between two frames in nanoseconds
+ *
+ * @requestType GetFrameClock
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::GetFrameClock(const Request &)
+{
+	auto requestScheduler = GetRequestScheduler();
+	if (!requestScheduler)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to get frame clock due to internal error.");
+
+	json responseData;
+	responseData["currentFrame"] = requestScheduler->GetFrameCount();
+	responseData["currentTimestamp"] = os_gettime_ns();
+	responseData["frameInterval"] = obs_get_frame_interval_ns();
+
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Schedules a request batch to be executed on an exact frame or at an exact time, unaffected by network latency.
+ *
+ * The requests are validated when the batch is scheduled, and are then executed serially within the graphics tick of the target frame.
+ * A batch scheduled by timestamp is executed on the first frame with a timestamp at or after `targetTimestamp`.
+ * Batches with a target in the past are executed on the next frame. `Sleep` requests are not supported.
+ * The results are sent to this session in the `ScheduledRequestBatchExecuted` event. The batch is dropped if the session disconnects first.
+ * Up to 256 batches per session, and 4096 in total, may be waiting to be executed.
+ *
+ * Use `GetFrameClock` to get the current frame and timestamp.
+ *
+ * @requestField requests         | Array<Object> | Array of requests to execute, like the `requests` of a `RequestBatch`
+ * @requestField ?targetFrame     | Number        | Frame to execute the batch on | >= 0 | `targetTimestamp` must be specified
+ * @requestField ?targetTimestamp | Number        | Time to execute the batch at, in nanoseconds of the OBS clock | >= 0 | `targetFrame` must be specified
+ * @requestField ?haltOnFailure   | Boolean       | Whether to halt processing of the batch on the first failed request | false
+ * @requestField ?atomic          | Boolean       | Whether to roll back all changes of the batch if a request fails | false
+ * @requestField ?variables       | Object        | Initial batch variables, used by the `inputVariables` of the requests | {}
+ *
+ * @responseField scheduleId | Number | ID of the scheduled batch, to be used with `CancelScheduledRequestBatch` and in the `ScheduledRequestBatchExecuted` event
+ *
+ * @requestType ScheduleRequestBatch
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::ScheduleRequestBatch(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!request.ValidateArray("requests", statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
+	ScheduledRequestBatch scheduledBatch;
+	scheduledBatch.Session = _session;
+
+	bool hasFrame = request.Contains("targetFrame");
+	if (hasFrame && !request.ValidateOptionalNumber("targetFrame", statusCode, comment, 0))
+		return RequestResult::Error(statusCode, comment);
+
+	bool hasTimestamp = request.Contains("targetTimestamp");
+	if (hasTimestamp && !request.ValidateOptionalNumber("targetTimestamp", statusCode, comment, 0))
+		return RequestResult::Error(statusCode, comment);
+
+	if (hasFrame && hasTimestamp)
+		return RequestResult::Error(RequestStatus::TooManyRequestFields, "You may only specify one target field.");
+
+	if (!hasFrame && !hasTimestamp)
+		return RequestResult::Error(RequestStatus::MissingRequestField, "You must specify one target field.");
+
+	scheduledBatch.TargetIsTimestamp = hasTimestamp;
+	scheduledBatch.Target = request.RequestData[hasTimestamp ? "targetTimestamp" : "targetFrame"].get<uint64_t>();
+
+	auto batchTemplate = std::make_shared<RequestBatchTemplate>();
+	batchTemplate->ExecutionType = RequestBatchExecutionType::SerialFrame;
+	batchTemplate->HaltOnFailure = false;
+	batchTemplate->Atomic = false;
+
+	if (request.Contains("haltOnFailure")) {
+		if (!request.ValidateOptionalBoolean("haltOnFailure", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		batchTemplate->HaltOnFailure = request.RequestData["haltOnFailure"];
+	}
+
+	if (request.Contains("atomic")) {
+		if (!request.ValidateOptionalBoolean("atomic", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		batchTemplate->Atomic = request.RequestData["atomic"];
+	}
+
+	scheduledBatch.Variables = json::object();
+	if (request.Contains("variables")) {
+		if (!request.ValidateOptionalObject("variables", statusCode, comment, true))
+			return RequestResult::Error(statusCode, comment);
+
+		scheduledBatch.Variables = request.RequestData["variables"];
+	}
+
+	if (!BuildRequestBatchTemplate(request.RequestData["requests"], *batchTemplate, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
+	// Sleeping would stall the graphics thread
+	for (auto &batchRequest : batchTemplate->Requests)
+		if (batchRequest.RequestType == "Sleep")
+			return RequestResult::Error(RequestStatus::InvalidRequestField,
+						    "`Sleep` requests are not supported in scheduled request batches.");
+
+	auto requestScheduler = GetRequestScheduler();
+	if (!requestScheduler)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to schedule request batch due to internal error.");
+
+	scheduledBatch.Batch = batchTemplate;
+
+	uint64_t scheduleId = requestScheduler->Schedule(std::move(scheduledBatch));
+	if (!scheduleId)
+		return RequestResult::Error(RequestStatus::NotEnoughResources, "Too many request batches are already scheduled.");
+
+	json responseData;
+	responseData["scheduleId"] = scheduleId;
+
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Cancels a request batch scheduled with `ScheduleRequestBatch` which has not been executed yet.
+ *
+ * Only batches scheduled by the same client can be cancelled.
+ *
+ * @requestField scheduleId | Number | ID of the scheduled batch to cancel | >= 1
+ *
+ * @requestType CancelScheduledRequestBatch
+ * @complexity 2
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::CancelScheduledRequestBatch(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!request.ValidateNumber("scheduleId", statusCode, comment, 1))
+		return RequestResult::Error(statusCode, comment);
+
+	auto requestScheduler = GetRequestScheduler();
+	if (!requestScheduler)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to cancel request batch due to internal error.");
+
+	uint64_t scheduleId = request.RequestData["scheduleId"];
+	if (!requestScheduler->Cancel(scheduleId, _session))
+		return RequestResult::Error(RequestStatus::ResourceNotFound, "No scheduled request batch was found by the ID of `" +
+										     std::to_string(scheduleId) + "`.");
+
+	return RequestResult::Success();
+}
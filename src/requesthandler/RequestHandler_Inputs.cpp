@@ -17,14 +17,29 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
+
 #include "RequestHandler.h"
+#include "AnimationManager.h"
+
+// Fields of `GetInputList` which may be selected with `responseFields`
+static const std::unordered_set<std::string> inputListFields = {
+	"inputName", "inputUuid", "inputKind", "unversionedInputKind", "inputKindCaps",
+};
 
 /**
  * Gets an array of all inputs in OBS.
  *
- * @requestField ?inputKind | String | Restrict the array to only inputs of the specified kind | All kinds included
+ * @requestField ?inputKind      | String        | Restrict the array to only inputs of the specified kind | All kinds included
+ * @requestField ?ifNoneMatch    | String        | ETag of a previous response. If the input list has not changed since, only `etag` and `notModified` are returned
+ * @requestField ?responseFields | Array<String> | Fields of each input to return. Unselected fields are not fetched | All fields
+ * @requestField ?pageSize       | Number        | Maximum number of inputs to return. Enables pagination | >= 1 | Not paginated
+ * @requestField ?pageCursor     | String        | `nextPageCursor` of the previous page. Requires `pageSize` | First page
  *
- * @responseField inputs | Array<Object> | Array of inputs
+ * @responseField etag           | String        | ETag of the input list, to be used as `ifNoneMatch` of a later request. The same for every page
+ * @responseField notModified    | Boolean       | Only returned (as `true`) if `ifNoneMatch` is equal to the current ETag
+ * @responseField inputs         | Array<Object> | Array of inputs
+ * @responseField nextPageCursor | String        | Only returned if paginated. Cursor of the next page, or `null` if this is the last page
  *
  * @requestType GetInputList
  * @complexity 2
@@ -35,20 +50,41 @@ with this program. If not, see <https://www.gnu.org/licenses/>
  */
 RequestResult RequestHandler::GetInputList(const Request &request)
 {
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
 	std::string inputKind;
 
 	if (request.Contains("inputKind")) {
-		RequestStatus::RequestStatus statusCode;
-		std::string comment;
 		if (!request.ValidateOptionalString("inputKind", statusCode, comment))
 			return RequestResult::Error(statusCode, comment);
 
 		inputKind = request.RequestData["inputKind"];
 	}
 
-	json responseData;
-	responseData["inputs"] = Utils::Obs::ArrayHelper::GetInputList(inputKind);
-	return RequestResult::Success(responseData);
+	Utils::Obs::FieldSelector fields;
+	size_t pageOffset, pageSize;
+	if (!(request.ValidateResponseFields(inputListFields, fields, statusCode, comment) &&
+	      ValidatePage(request, pageOffset, pageSize, statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	std::string resourceId = inputKind + "|" + fields.ToString();
+	std::string etag = GetETag(request.RequestType, resourceId, {"inputList"});
+	bool notModified;
+	if (!CheckETag(request, etag, notModified, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+	if (notModified)
+		return RequestResult::NotModified(etag);
+
+	// The full list is cached, and then paginated
+	ResponseCache::Payload responseData = GetCachedResponse(request, resourceId, etag);
+	if (!responseData) {
+		json inputList;
+		inputList["etag"] = etag;
+		inputList["inputs"] = Utils::Obs::ArrayHelper::GetInputList(inputKind, fields);
+		responseData = CacheResponse(request, resourceId, etag, std::move(inputList));
+	}
+
+	return RequestResult::Success(GetPage(*responseData, "inputs", pageOffset, pageSize));
 }
 
 /**
@@ -321,10 +357,15 @@ RequestResult RequestHandler::GetInputSettings(const Request &request)
 
 	OBSDataAutoRelease inputSettings = obs_source_get_settings(input);
 
-	json responseData;
-	responseData["inputSettings"] = Utils::Json::ObsDataToJson(inputSettings);
-	responseData["inputKind"] = obs_source_get_id(input);
-	return RequestResult::Success(responseData);
+	RequestResult ret = RequestResult::Success();
+	if (request.RawFieldEncodings) {
+		ret.ResponseRawFields = Utils::Json::RawFields(request.RawFieldEncodings);
+		ret.ResponseData["inputSettings"] = ret.ResponseRawFields.Add(inputSettings);
+	} else {
+		ret.ResponseData["inputSettings"] = Utils::Json::ObsDataToJson(inputSettings);
+	}
+	ret.ResponseData["inputKind"] = obs_source_get_id(input);
+	return ret;
 }
 
 /**
@@ -562,6 +603,95 @@ RequestResult RequestHandler::SetInputVolume(const Request &request)
 	return RequestResult::Success();
 }
 
+/**
+ * Fades the volume setting of an input to a new value over a duration.
+ *
+ * The fade is run by obs-websocket on every frame, so the client only has to send a single request.
+ * The volume is interpolated in dB, so that the loudness follows the easing curve. Silence is treated as -100 dB.
+ * The `AnimationEnded` event is emitted once it completes or is cancelled. Starting another fade on the same input cancels the running one.
+ *
+ * @requestField ?inputName      | String | Name of the input to fade the volume of
+ * @requestField ?inputUuid      | String | UUID of the input to fade the volume of
+ * @requestField ?inputVolumeMul | Number | Volume setting to fade to in mul | >= 0, <= 20     | `inputVolumeDb` should be specified
+ * @requestField ?inputVolumeDb  | Number | Volume setting to fade to in dB  | >= -100, <= 26 | `inputVolumeMul` should be specified
+ * @requestField duration        | Number | Duration of the fade in milliseconds | >= 0, <= 3600000
+ * @requestField ?easing         | Number | `AnimationEasing` curve of the fade | >= 0, <= 3 | `Linear`
+ *
+ * @responseField animationId | Number | ID of the fade, to be used with `StopAnimation` and in the `AnimationEnded` event
+ *
+ * @requestType FadeInputVolume
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category inputs
+ */
+RequestResult RequestHandler::FadeInputVolume(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSourceAutoRelease input = request.AcquireInput(statusCode, comment);
+	uint64_t duration;
+	AnimationEasing::AnimationEasing easing;
+	if (!(input && ValidateAnimation(request, duration, easing, statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	if (!(obs_source_get_output_flags(input) & OBS_SOURCE_AUDIO))
+		return RequestResult::Error(RequestStatus::InvalidResourceState, "The specified input does not support audio.");
+
+	bool hasMul = request.Contains("inputVolumeMul");
+	if (hasMul && !request.ValidateOptionalNumber("inputVolumeMul", statusCode, comment, 0, 20))
+		return RequestResult::Error(statusCode, comment);
+
+	bool hasDb = request.Contains("inputVolumeDb");
+	if (hasDb && !request.ValidateOptionalNumber("inputVolumeDb", statusCode, comment, -100, 26))
+		return RequestResult::Error(statusCode, comment);
+
+	if (hasMul && hasDb)
+		return RequestResult::Error(RequestStatus::TooManyRequestFields, "You may only specify one volume field.");
+
+	if (!hasMul && !hasDb)
+		return RequestResult::Error(RequestStatus::MissingRequestField, "You must specify one volume field.");
+
+	auto animationManager = GetAnimationManager();
+	if (!animationManager)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Unable to start fade due to internal error.");
+
+	float inputVolumeMul;
+	if (hasMul)
+		inputVolumeMul = request.RequestData["inputVolumeMul"];
+	else
+		inputVolumeMul = obs_db_to_mul(request.RequestData["inputVolumeDb"]);
+
+	// `obs_mul_to_db()` returns -inf for silence
+	float startDb = std::max(obs_mul_to_db(obs_source_get_volume(input)), -100.0f);
+	float endDb = std::max(obs_mul_to_db(inputVolumeMul), -100.0f);
+
+	std::string inputUuid = obs_source_get_uuid(input);
+
+	json targetData;
+	targetData["inputName"] = obs_source_get_name(input);
+	targetData["inputUuid"] = inputUuid;
+
+	OBSWeakSource weakInput = OBSGetWeakRef(input);
+	auto applyVolume = [weakInput, startDb, endDb, inputVolumeMul](float progress) {
+		OBSSourceAutoRelease input = obs_weak_source_get_source(weakInput);
+		if (!input || obs_source_removed(input))
+			return false;
+
+		// The exact target is set at the end, as silence cannot be reached in dB
+		float volumeMul = progress < 1.0f ? obs_db_to_mul(AnimationManager::Lerp(startDb, endDb, progress)) : inputVolumeMul;
+		obs_source_set_volume(input, volumeMul);
+		return true;
+	};
+
+	json responseData;
+	responseData["animationId"] =
+		animationManager->Start(request.RequestType, "inputVolume:" + inputUuid, targetData, duration, easing, applyVolume);
+
+	return RequestResult::Success(responseData);
+}
+
 /**
  * Gets the audio balance of an input.
  *
@@ -867,6 +997,157 @@ RequestResult RequestHandler::SetInputAudioTracks(const Request &request)
 	return RequestResult::Success();
 }
 
+// Fields of `GetInputAudioStates` which may be selected with `responseFields`
+static const std::unordered_set<std::string> inputAudioStateFields = {
+	"inputName", "inputUuid", "inputMuted", "inputVolumeMul", "inputVolumeDb",
+	"inputAudioBalance", "inputAudioSyncOffset", "monitorType", "inputAudioTracks",
+};
+
+// Selected fields are looked up once per request instead of once per input
+struct InputAudioStateFields {
+	InputAudioStateFields(const Utils::Obs::FieldSelector &fields)
+		: inputName(fields.Has("inputName")),
+		  inputUuid(fields.Has("inputUuid")),
+		  inputMuted(fields.Has("inputMuted")),
+		  inputVolume(fields.Has("inputVolumeMul") || fields.Has("inputVolumeDb")),
+		  inputAudioBalance(fields.Has("inputAudioBalance")),
+		  inputAudioSyncOffset(fields.Has("inputAudioSyncOffset")),
+		  monitorType(fields.Has("monitorType")),
+		  inputAudioTracks(fields.Has("inputAudioTracks"))
+	{
+	}
+
+	bool inputName;
+	bool inputUuid;
+	bool inputMuted;
+	bool inputVolume;
+	bool inputAudioBalance;
+	bool inputAudioSyncOffset;
+	bool monitorType;
+	bool inputAudioTracks;
+};
+
+static json GetInputAudioState(obs_source_t *input, const InputAudioStateFields &fields)
+{
+	json ret = json::object();
+
+	if (fields.inputName)
+		ret["inputName"] = obs_source_get_name(input);
+	if (fields.inputUuid)
+		ret["inputUuid"] = obs_source_get_uuid(input);
+	if (fields.inputMuted)
+		ret["inputMuted"] = obs_source_muted(input);
+	if (fields.inputVolume) {
+		float inputVolumeMul = obs_source_get_volume(input);
+		float inputVolumeDb = obs_mul_to_db(inputVolumeMul);
+		if (inputVolumeDb == -INFINITY)
+			inputVolumeDb = -100.0;
+		ret["inputVolumeMul"] = inputVolumeMul;
+		ret["inputVolumeDb"] = inputVolumeDb;
+	}
+	if (fields.inputAudioBalance)
+		ret["inputAudioBalance"] = obs_source_get_balance_value(input);
+	if (fields.inputAudioSyncOffset)
+		ret["inputAudioSyncOffset"] = obs_source_get_sync_offset(input) / 1000000;
+	if (fields.monitorType)
+		ret["monitorType"] = obs_source_get_monitoring_type(input);
+	if (fields.inputAudioTracks) {
+		long long tracks = obs_source_get_audio_mixers(input);
+		json inputAudioTracks;
+		for (long long i = 0; i < MAX_AUDIO_MIXES; i++)
+			inputAudioTracks[std::to_string(i + 1)] = (bool)((tracks >> i) & 1);
+		ret["inputAudioTracks"] = inputAudioTracks;
+	}
+
+	return ret;
+}
+
+struct EnumInputAudioStateInfo {
+	EnumInputAudioStateInfo(const Utils::Obs::FieldSelector &fields) : fields(fields) {}
+
+	InputAudioStateFields fields;
+	std::vector<json> inputs;
+};
+
+/**
+ * Gets the audio state of multiple inputs at once. Equivalent to calling `GetInputMute`, `GetInputVolume`, `GetInputAudioBalance`,
+ * `GetInputAudioSyncOffset`, `GetInputAudioMonitorType` and `GetInputAudioTracks` for each input.
+ *
+ * If neither `inputNames` nor `inputUuids` is specified, all inputs which support audio are returned.
+ *
+ * @requestField ?inputNames     | Array<String> | Names of the inputs to get the audio state of | All audio inputs
+ * @requestField ?inputUuids     | Array<String> | UUIDs of the inputs to get the audio state of. Used instead of `inputNames` if both are specified | All audio inputs
+ * @requestField ?responseFields | Array<String> | Fields of each input to return. Unselected fields are not fetched | All fields
+ *
+ * @responseField inputs | Array<Object> | Array of audio states, in the order of the requested inputs. Each contains `inputName`, `inputUuid`, `inputMuted`, `inputVolumeMul`, `inputVolumeDb`, `inputAudioBalance`, `inputAudioSyncOffset`, `monitorType` and `inputAudioTracks`
+ *
+ * @requestType GetInputAudioStates
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category inputs
+ */
+RequestResult RequestHandler::GetInputAudioStates(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	Utils::Obs::FieldSelector fields;
+	if (!request.ValidateResponseFields(inputAudioStateFields, fields, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
+	EnumInputAudioStateInfo enumInfo(fields);
+
+	std::string keyName = request.Contains("inputUuids") ? "inputUuids" : "inputNames";
+	if (request.Contains(keyName)) {
+		if (!request.ValidateOptionalArray(keyName, statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		// Each input is only looked up once, and not through a separate request
+		bool byUuid = keyName == "inputUuids";
+		const json &inputIds = request.RequestData[keyName];
+		enumInfo.inputs.reserve(inputIds.size());
+		for (auto &inputId : inputIds) {
+			if (!inputId.is_string())
+				return RequestResult::Error(RequestStatus::InvalidRequestFieldType,
+							    std::string("The field value of `") + keyName +
+								    "` must be an array of strings.");
+
+			std::string inputIdString = inputId;
+			OBSSourceAutoRelease input = byUuid ? obs_get_source_by_uuid(inputIdString.c_str())
+							    : obs_get_source_by_name(inputIdString.c_str());
+			if (!input || obs_source_get_type(input) != OBS_SOURCE_TYPE_INPUT)
+				return RequestResult::Error(RequestStatus::ResourceNotFound,
+							    std::string("No input was found by the ") + (byUuid ? "UUID" : "name") +
+								    " of `" + inputIdString + "`.");
+
+			if (!(obs_source_get_output_flags(input) & OBS_SOURCE_AUDIO))
+				return RequestResult::Error(RequestStatus::InvalidResourceState,
+							    std::string("The input `") + inputIdString + "` does not support audio.");
+
+			enumInfo.inputs.push_back(GetInputAudioState(input, enumInfo.fields));
+		}
+	} else {
+		auto cb = [](void *param, obs_source_t *input) {
+			auto enumInfo = static_cast<EnumInputAudioStateInfo *>(param);
+
+			if (obs_source_get_type(input) != OBS_SOURCE_TYPE_INPUT)
+				return true;
+
+			if (obs_source_get_output_flags(input) & OBS_SOURCE_AUDIO)
+				enumInfo->inputs.push_back(GetInputAudioState(input, enumInfo->fields));
+
+			return true;
+		};
+
+		obs_enum_sources(cb, &enumInfo);
+	}
+
+	json responseData;
+	responseData["inputs"] = enumInfo.inputs;
+	return RequestResult::Success(responseData);
+}
+
 /**
  * Gets the deinterlace mode of an input.
  *
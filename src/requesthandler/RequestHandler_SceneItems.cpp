@@ -17,18 +17,49 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
+#include <cmath>
+
 #include "RequestHandler.h"
+#include "AnimationManager.h"
+
+// Fields of `GetSceneItemList` and `GetGroupSceneItemList` which may be selected with `responseFields`
+static const std::unordered_set<std::string> sceneItemListFields = {
+	"sceneItemId", "sceneItemIndex", "sceneItemEnabled", "sceneItemLocked", "sceneItemTransform",
+	"sceneItemBlendMode", "sourceName", "sourceUuid", "sourceType", "inputKind", "isGroup",
+};
+
+// Blend modes can be changed from the OBS UI without emitting an event, so they are compared directly by ETags
+static std::string GetSceneItemBlendModes(obs_scene_t *scene)
+{
+	std::string blendModes;
+	auto cb = [](obs_scene_t *, obs_sceneitem_t *sceneItem, void *param) {
+		auto blendModes = static_cast<std::string *>(param);
+		*blendModes += (char)obs_sceneitem_get_blending_mode(sceneItem);
+		return true;
+	};
+	obs_scene_enum_items(scene, cb, &blendModes);
+
+	return blendModes;
+}
 
 /**
  * Gets a list of all scene items in a scene.
  *
  * Scenes only
  *
- * @requestField ?canvasUuid | String | UUID of the canvas the scene is in, if using the sceneName field
- * @requestField ?sceneName  | String | Name of the scene to get the items of
- * @requestField ?sceneUuid  | String | UUID of the scene to get the items of
+ * @requestField ?canvasUuid     | String        | UUID of the canvas the scene is in, if using the sceneName field
+ * @requestField ?sceneName      | String        | Name of the scene to get the items of
+ * @requestField ?sceneUuid      | String        | UUID of the scene to get the items of
+ * @requestField ?ifNoneMatch    | String        | ETag of a previous response. If the scene items have not changed since, only `etag` and `notModified` are returned
+ * @requestField ?responseFields | Array<String> | Fields of each scene item to return. Unselected fields are not fetched | All fields
+ * @requestField ?pageSize       | Number        | Maximum number of scene items to return. Enables pagination | >= 1 | Not paginated
+ * @requestField ?pageCursor     | String        | `nextPageCursor` of the previous page. Requires `pageSize` | First page
  *
- * @responseField sceneItems | Array<Object> | Array of scene items in the scene
+ * @responseField etag           | String        | ETag of the scene item list, to be used as `ifNoneMatch` of a later request. The same for every page
+ * @responseField notModified    | Boolean       | Only returned (as `true`) if `ifNoneMatch` is equal to the current ETag
+ * @responseField sceneItems     | Array<Object> | Array of scene items in the scene
+ * @responseField nextPageCursor | String        | Only returned if paginated. Cursor of the next page, or `null` if this is the last page
  *
  * @requestType GetSceneItemList
  * @complexity 3
@@ -42,13 +73,36 @@ RequestResult RequestHandler::GetSceneItemList(const Request &request)
 	RequestStatus::RequestStatus statusCode;
 	std::string comment;
 	OBSSourceAutoRelease scene = request.AcquireScene(statusCode, comment);
-	if (!scene)
+	Utils::Obs::FieldSelector fields;
+	size_t pageOffset, pageSize;
+	if (!(scene && request.ValidateResponseFields(sceneItemListFields, fields, statusCode, comment) &&
+	      ValidatePage(request, pageOffset, pageSize, statusCode, comment)))
 		return RequestResult::Error(statusCode, comment);
 
-	json responseData;
-	responseData["sceneItems"] = Utils::Obs::ArrayHelper::GetSceneItemList(obs_scene_from_source(scene));
+	// Scene items contain the names of their sources
+	std::string sceneUuid = obs_source_get_uuid(scene);
+	std::string resourceId = sceneUuid + "|" + fields.ToString();
+	std::string blendModes = fields.Has("sceneItemBlendMode") ? GetSceneItemBlendModes(obs_scene_from_source(scene)) : "";
+	std::vector<std::string> resourceKeys = {"sceneItems:" + sceneUuid, "sourceNames"};
+	if (fields.Has("sceneItemTransform"))
+		resourceKeys.push_back("sceneItemTransforms");
+	std::string etag = GetETag(request.RequestType, resourceId, resourceKeys, blendModes);
+	bool notModified;
+	if (!CheckETag(request, etag, notModified, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+	if (notModified)
+		return RequestResult::NotModified(etag);
+
+	// The full list is cached, and then paginated
+	ResponseCache::Payload responseData = GetCachedResponse(request, resourceId, etag);
+	if (!responseData) {
+		json sceneItemList;
+		sceneItemList["etag"] = etag;
+		sceneItemList["sceneItems"] = Utils::Obs::ArrayHelper::GetSceneItemList(obs_scene_from_source(scene), fields);
+		responseData = CacheResponse(request, resourceId, etag, std::move(sceneItemList));
+	}
 
-	return RequestResult::Success(responseData);
+	return RequestResult::Success(GetPage(*responseData, "sceneItems", pageOffset, pageSize));
 }
 
 /**
@@ -58,9 +112,10 @@ RequestResult RequestHandler::GetSceneItemList(const Request &request)
  *
  * Groups only
  *
- * @requestField ?canvasUuid | String | UUID of the canvas the group is in, if using the sceneName field
- * @requestField ?sceneName  | String | Name of the group to get the items of
- * @requestField ?sceneUuid  | String | UUID of the group to get the items of
+ * @requestField ?canvasUuid     | String        | UUID of the canvas the group is in, if using the sceneName field
+ * @requestField ?sceneName      | String        | Name of the group to get the items of
+ * @requestField ?sceneUuid      | String        | UUID of the group to get the items of
+ * @requestField ?responseFields | Array<String> | Fields of each scene item to return. Unselected fields are not fetched | All fields
  *
  * @responseField sceneItems | Array<Object> | Array of scene items in the group
  *
@@ -76,11 +131,12 @@ RequestResult RequestHandler::GetGroupSceneItemList(const Request &request)
 	RequestStatus::RequestStatus statusCode;
 	std::string comment;
 	OBSSourceAutoRelease scene = request.AcquireScene(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_GROUP_ONLY);
-	if (!scene)
+	Utils::Obs::FieldSelector fields;
+	if (!(scene && request.ValidateResponseFields(sceneItemListFields, fields, statusCode, comment)))
 		return RequestResult::Error(statusCode, comment);
 
 	json responseData;
-	responseData["sceneItems"] = Utils::Obs::ArrayHelper::GetSceneItemList(obs_group_from_source(scene));
+	responseData["sceneItems"] = Utils::Obs::ArrayHelper::GetSceneItemList(obs_group_from_source(scene), fields);
 
 	return RequestResult::Success(responseData);
 }
@@ -365,169 +421,520 @@ RequestResult RequestHandler::GetSceneItemTransform(const Request &request)
 	return RequestResult::Success(responseData);
 }
 
-/**
- * Sets the transform and crop info of a scene item.
- *
- * @requestField ?canvasUuid        | String | UUID of the canvas the scene is in, if using the sceneName field
- * @requestField ?sceneName         | String | Name of the scene the item is in
- * @requestField ?sceneUuid         | String | UUID of the scene the item is in
- * @requestField sceneItemId        | Number | Numeric ID of the scene item | >= 0
- * @requestField sceneItemTransform | Object | Object containing scene item transform info to update
- *
- * @requestType SetSceneItemTransform
- * @complexity 3
- * @rpcVersion -1
- * @initialVersion 5.0.0
- * @api requests
- * @category scene items
- */
-RequestResult RequestHandler::SetSceneItemTransform(const Request &request)
+struct SceneItemTransformUpdate {
+	OBSSceneItem sceneItem;
+	obs_transform_info transform;
+	obs_sceneitem_crop crop;
+	bool transformChanged = false;
+	bool cropChanged = false;
+};
+
+// Starts an update from the current transform of the scene item
+static void InitSceneItemTransformUpdate(obs_sceneitem_t *sceneItem, SceneItemTransformUpdate &update)
 {
-	RequestStatus::RequestStatus statusCode;
-	std::string comment;
-	OBSSceneItemAutoRelease sceneItem = request.AcquireSceneItem(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_SCENE_OR_GROUP);
-	if (!(sceneItem && request.ValidateObject("sceneItemTransform", statusCode, comment)))
-		return RequestResult::Error(statusCode, comment);
+	update.sceneItem = sceneItem;
+	obs_sceneitem_get_info2(sceneItem, &update.transform);
+	obs_sceneitem_get_crop(sceneItem, &update.crop);
+}
 
+// Validates a `sceneItemTransform` object and merges it into the transform of the update, without applying it
+static bool ParseSceneItemTransform(const json &transformJson, SceneItemTransformUpdate &update,
+				    RequestStatus::RequestStatus &statusCode, std::string &comment)
+{
 	// Create a fake request to use checks on the sub object
-	Request r("", request.RequestData["sceneItemTransform"]);
+	Request r("", transformJson);
 
-	bool transformChanged = false;
-	bool cropChanged = false;
-	obs_transform_info sceneItemTransform;
-	obs_sceneitem_crop sceneItemCrop;
-	obs_sceneitem_get_info2(sceneItem, &sceneItemTransform);
-	obs_sceneitem_get_crop(sceneItem, &sceneItemCrop);
+	obs_transform_info &sceneItemTransform = update.transform;
+	obs_sceneitem_crop &sceneItemCrop = update.crop;
 
-	OBSSource source = obs_sceneitem_get_source(sceneItem);
+	OBSSource source = obs_sceneitem_get_source(update.sceneItem);
 	float sourceWidth = float(obs_source_get_width(source));
 	float sourceHeight = float(obs_source_get_height(source));
 
 	if (r.Contains("positionX")) {
 		if (!r.ValidateOptionalNumber("positionX", statusCode, comment, -90001.0, 90001.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.pos.x = r.RequestData["positionX"];
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 	if (r.Contains("positionY")) {
 		if (!r.ValidateOptionalNumber("positionY", statusCode, comment, -90001.0, 90001.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.pos.y = r.RequestData["positionY"];
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 
 	if (r.Contains("rotation")) {
 		if (!r.ValidateOptionalNumber("rotation", statusCode, comment, -360.0, 360.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.rot = r.RequestData["rotation"];
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 
 	if (r.Contains("scaleX")) {
 		if (!r.ValidateOptionalNumber("scaleX", statusCode, comment))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		float scaleX = r.RequestData["scaleX"];
 		float finalWidth = scaleX * sourceWidth;
-		if (!(finalWidth > -90001.0 && finalWidth < 90001.0))
-			return RequestResult::Error(RequestStatus::RequestFieldOutOfRange,
-						    "The field `scaleX` is too small or large for the current source resolution.");
+		if (!(finalWidth > -90001.0 && finalWidth < 90001.0)) {
+			statusCode = RequestStatus::RequestFieldOutOfRange;
+			comment = "The field `scaleX` is too small or large for the current source resolution.";
+			return false;
+		}
 		sceneItemTransform.scale.x = scaleX;
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 	if (r.Contains("scaleY")) {
 		if (!r.ValidateOptionalNumber("scaleY", statusCode, comment, -90001.0, 90001.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		float scaleY = r.RequestData["scaleY"];
 		float finalHeight = scaleY * sourceHeight;
-		if (!(finalHeight > -90001.0 && finalHeight < 90001.0))
-			return RequestResult::Error(RequestStatus::RequestFieldOutOfRange,
-						    "The field `scaleY` is too small or large for the current source resolution.");
+		if (!(finalHeight > -90001.0 && finalHeight < 90001.0)) {
+			statusCode = RequestStatus::RequestFieldOutOfRange;
+			comment = "The field `scaleY` is too small or large for the current source resolution.";
+			return false;
+		}
 		sceneItemTransform.scale.y = scaleY;
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 
 	if (r.Contains("alignment")) {
 		if (!r.ValidateOptionalNumber("alignment", statusCode, comment, 0, std::numeric_limits<uint32_t>::max()))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.alignment = r.RequestData["alignment"];
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 
 	if (r.Contains("boundsType")) {
 		if (!r.ValidateOptionalString("boundsType", statusCode, comment))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		enum obs_bounds_type boundsType = r.RequestData["boundsType"];
-		if (boundsType == OBS_BOUNDS_NONE && r.RequestData["boundsType"] != "OBS_BOUNDS_NONE")
-			return RequestResult::Error(RequestStatus::InvalidRequestField,
-						    "The field `boundsType` has an invalid value.");
+		if (boundsType == OBS_BOUNDS_NONE && r.RequestData["boundsType"] != "OBS_BOUNDS_NONE") {
+			statusCode = RequestStatus::InvalidRequestField;
+			comment = "The field `boundsType` has an invalid value.";
+			return false;
+		}
 		sceneItemTransform.bounds_type = boundsType;
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 
 	if (r.Contains("boundsAlignment")) {
 		if (!r.ValidateOptionalNumber("boundsAlignment", statusCode, comment, 0, std::numeric_limits<uint32_t>::max()))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.bounds_alignment = r.RequestData["boundsAlignment"];
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 
 	if (r.Contains("boundsWidth")) {
 		if (!r.ValidateOptionalNumber("boundsWidth", statusCode, comment, 1.0, 90001.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.bounds.x = r.RequestData["boundsWidth"];
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 	if (r.Contains("boundsHeight")) {
 		if (!r.ValidateOptionalNumber("boundsHeight", statusCode, comment, 1.0, 90001.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.bounds.y = r.RequestData["boundsHeight"];
-		transformChanged = true;
+		update.transformChanged = true;
 	}
 
 	if (r.Contains("cropLeft")) {
 		if (!r.ValidateOptionalNumber("cropLeft", statusCode, comment, 0.0, 100000.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemCrop.left = r.RequestData["cropLeft"];
-		cropChanged = true;
+		update.cropChanged = true;
 	}
 	if (r.Contains("cropRight")) {
 		if (!r.ValidateOptionalNumber("cropRight", statusCode, comment, 0.0, 100000.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemCrop.right = r.RequestData["cropRight"];
-		cropChanged = true;
+		update.cropChanged = true;
 	}
 	if (r.Contains("cropTop")) {
 		if (!r.ValidateOptionalNumber("cropTop", statusCode, comment, 0.0, 100000.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemCrop.top = r.RequestData["cropTop"];
-		cropChanged = true;
+		update.cropChanged = true;
 	}
 	if (r.Contains("cropBottom")) {
 		if (!r.ValidateOptionalNumber("cropBottom", statusCode, comment, 0.0, 100000.0))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemCrop.bottom = r.RequestData["cropBottom"];
-		cropChanged = true;
+		update.cropChanged = true;
 	}
 
 	if (r.Contains("cropToBounds")) {
 		if (!r.ValidateOptionalBoolean("cropToBounds", statusCode, comment))
-			return RequestResult::Error(statusCode, comment);
+			return false;
 		sceneItemTransform.crop_to_bounds = r.RequestData["cropToBounds"];
-		transformChanged = true;
+		update.transformChanged = true;
+	}
+
+	if (!update.transformChanged && !update.cropChanged) {
+		statusCode = RequestStatus::CannotAct;
+		comment = "You have not provided any valid transform changes.";
+		return false;
+	}
+
+	return true;
+}
+
+static void ApplySceneItemTransform(const SceneItemTransformUpdate &update)
+{
+	if (update.transformChanged)
+		obs_sceneitem_set_info2(update.sceneItem, &update.transform);
+
+	if (update.cropChanged)
+		obs_sceneitem_set_crop(update.sceneItem, &update.crop);
+}
+
+/**
+ * Sets the transform and crop info of a scene item.
+ *
+ * @requestField ?canvasUuid        | String | UUID of the canvas the scene is in, if using the sceneName field
+ * @requestField ?sceneName         | String | Name of the scene the item is in
+ * @requestField ?sceneUuid         | String | UUID of the scene the item is in
+ * @requestField sceneItemId        | Number | Numeric ID of the scene item | >= 0
+ * @requestField sceneItemTransform | Object | Object containing scene item transform info to update
+ *
+ * @requestType SetSceneItemTransform
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.0.0
+ * @api requests
+ * @category scene items
+ */
+RequestResult RequestHandler::SetSceneItemTransform(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneItemAutoRelease sceneItem = request.AcquireSceneItem(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_SCENE_OR_GROUP);
+	if (!(sceneItem && request.ValidateObject("sceneItemTransform", statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	SceneItemTransformUpdate update;
+	InitSceneItemTransformUpdate(sceneItem, update);
+	if (!ParseSceneItemTransform(request.RequestData["sceneItemTransform"], update, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+
+	ApplySceneItemTransform(update);
+
+	return RequestResult::Success();
+}
+
+// Scene items of a scene by ID, so that many items can be looked up without searching the scene for each one
+static std::unordered_map<int64_t, obs_sceneitem_t *> GetSceneItemMap(obs_scene_t *scene)
+{
+	std::unordered_map<int64_t, obs_sceneitem_t *> ret;
+
+	auto cb = [](obs_scene_t *, obs_sceneitem_t *sceneItem, void *param) {
+		auto ret = static_cast<std::unordered_map<int64_t, obs_sceneitem_t *> *>(param);
+		ret->emplace(obs_sceneitem_get_id(sceneItem), sceneItem);
+		return true;
+	};
+
+	obs_scene_enum_items(scene, cb, &ret);
+
+	return ret;
+}
+
+/**
+ * Gets the transform and crop info of multiple scene items in a scene at once.
+ *
+ * Scenes and Groups
+ *
+ * @requestField ?canvasUuid   | String        | UUID of the canvas the scene is in, if using the sceneName field
+ * @requestField ?sceneName    | String        | Name of the scene the items are in
+ * @requestField ?sceneUuid    | String        | UUID of the scene the items are in
+ * @requestField ?sceneItemIds | Array<Number> | Numeric IDs of the scene items | All scene items in the scene
+ *
+ * @responseField sceneItemTransforms | Array<Object> | Array of objects containing `sceneItemId` and `sceneItemTransform`, in the order of `sceneItemIds`
+ *
+ * @requestType GetSceneItemTransforms
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category scene items
+ */
+RequestResult RequestHandler::GetSceneItemTransforms(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneAutoRelease scene = request.AcquireScene2(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_SCENE_OR_GROUP);
+	if (!scene)
+		return RequestResult::Error(statusCode, comment);
+
+	std::vector<json> sceneItemTransforms;
+
+	if (request.Contains("sceneItemIds")) {
+		if (!request.ValidateOptionalArray("sceneItemIds", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		auto sceneItems = GetSceneItemMap(scene);
+		const json &sceneItemIds = request.RequestData["sceneItemIds"];
+		sceneItemTransforms.reserve(sceneItemIds.size());
+		for (auto &sceneItemId : sceneItemIds) {
+			if (!sceneItemId.is_number_unsigned())
+				return RequestResult::Error(RequestStatus::InvalidRequestFieldType,
+							    "The field value of `sceneItemIds` must be an array of numbers.");
+
+			auto it = sceneItems.find(sceneItemId.get<int64_t>());
+			if (it == sceneItems.end())
+				return RequestResult::Error(RequestStatus::ResourceNotFound,
+							    "No scene item was found by the ID of `" + sceneItemId.dump() + "`.");
+
+			json sceneItemTransform;
+			sceneItemTransform["sceneItemId"] = sceneItemId;
+			sceneItemTransform["sceneItemTransform"] = Utils::Obs::ObjectHelper::GetSceneItemTransform(it->second);
+			sceneItemTransforms.push_back(std::move(sceneItemTransform));
+		}
+	} else {
+		auto cb = [](obs_scene_t *, obs_sceneitem_t *sceneItem, void *param) {
+			auto sceneItemTransforms = static_cast<std::vector<json> *>(param);
+
+			json sceneItemTransform;
+			sceneItemTransform["sceneItemId"] = obs_sceneitem_get_id(sceneItem);
+			sceneItemTransform["sceneItemTransform"] = Utils::Obs::ObjectHelper::GetSceneItemTransform(sceneItem);
+			sceneItemTransforms->push_back(std::move(sceneItemTransform));
+
+			return true;
+		};
+
+		obs_scene_enum_items(scene, cb, &sceneItemTransforms);
 	}
 
-	if (!transformChanged && !cropChanged)
-		return RequestResult::Error(RequestStatus::CannotAct, "You have not provided any valid transform changes.");
+	json responseData;
+	responseData["sceneItemTransforms"] = sceneItemTransforms;
+
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Sets the transform and crop info of multiple scene items in a scene at once.
+ *
+ * All transforms are validated before any are applied, and are then applied within a single scene update, so that every item changes on the same frame.
+ *
+ * Scenes and Groups
+ *
+ * @requestField ?canvasUuid         | String        | UUID of the canvas the scene is in, if using the sceneName field
+ * @requestField ?sceneName          | String        | Name of the scene the items are in
+ * @requestField ?sceneUuid          | String        | UUID of the scene the items are in
+ * @requestField sceneItemTransforms | Array<Object> | Array of objects containing `sceneItemId` and `sceneItemTransform`, like `SetSceneItemTransform`. Each scene item may only be included once
+ *
+ * @requestType SetSceneItemTransforms
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category scene items
+ */
+RequestResult RequestHandler::SetSceneItemTransforms(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneAutoRelease scene = request.AcquireScene2(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_SCENE_OR_GROUP);
+	if (!(scene && request.ValidateArray("sceneItemTransforms", statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	auto sceneItems = GetSceneItemMap(scene);
+	const json &transforms = request.RequestData["sceneItemTransforms"];
+
+	std::vector<SceneItemTransformUpdate> updates(transforms.size());
+	std::unordered_set<int64_t> sceneItemIds;
+	for (size_t i = 0; i < transforms.size(); i++) {
+		const json &transform = transforms[i];
+		std::string prefix = "sceneItemTransforms[" + std::to_string(i) + "]: ";
+
+		// `transform` is const, so keys must exist before they are accessed
+		if (!transform.is_object() || !transform.contains("sceneItemId") ||
+		    !transform["sceneItemId"].is_number_unsigned() || !transform.contains("sceneItemTransform") ||
+		    !transform["sceneItemTransform"].is_object())
+			return RequestResult::Error(RequestStatus::InvalidRequestFieldType,
+						    prefix + "Must contain `sceneItemId` and a `sceneItemTransform` object.");
+
+		int64_t sceneItemId = transform["sceneItemId"];
+		std::string sceneItemIdString = std::to_string(sceneItemId);
+		auto it = sceneItems.find(sceneItemId);
+		if (it == sceneItems.end())
+			return RequestResult::Error(RequestStatus::ResourceNotFound,
+						    prefix + "No scene item was found by the ID of `" + sceneItemIdString + "`.");
+
+		if (!sceneItemIds.insert(sceneItemId).second)
+			return RequestResult::Error(RequestStatus::InvalidRequestField,
+						    prefix + "The scene item `" + sceneItemIdString + "` is included twice.");
+
+		InitSceneItemTransformUpdate(it->second, updates[i]);
+		if (!ParseSceneItemTransform(transform["sceneItemTransform"], updates[i], statusCode, comment))
+			return RequestResult::Error(statusCode, prefix + comment);
+	}
 
-	if (transformChanged)
-		obs_sceneitem_set_info2(sceneItem, &sceneItemTransform);
+	// Holding the scene lock means that the render thread sees either none or all of the changes
+	auto cb = [](void *param, obs_scene_t *) {
+		auto updates = static_cast<std::vector<SceneItemTransformUpdate> *>(param);
+		for (auto &update : *updates)
+			ApplySceneItemTransform(update);
+	};
 
-	if (cropChanged)
-		obs_sceneitem_set_crop(sceneItem, &sceneItemCrop);
+	obs_scene_atomic_update(scene, cb, &updates);
 
 	return RequestResult::Success();
 }
 
+struct SceneItemKeyframe {
+	float offset;
+	obs_transform_info transform;
+	obs_sceneitem_crop crop;
+};
+
+static inline int LerpCrop(int a, int b, float t)
+{
+	return (int)std::lround(AnimationManager::Lerp(float(a), float(b), t));
+}
+
+// Non-numeric fields (alignment, bounds type, crop to bounds) switch to the next keyframe once it is reached
+static void ApplySceneItemKeyframes(obs_sceneitem_t *sceneItem, const std::vector<SceneItemKeyframe> &keyframes, float progress)
+{
+	size_t next = 1;
+	while (next < keyframes.size() - 1 && keyframes[next].offset < progress)
+		next++;
+
+	const SceneItemKeyframe &a = keyframes[next - 1];
+	const SceneItemKeyframe &b = keyframes[next];
+	float t = std::clamp((progress - a.offset) / (b.offset - a.offset), 0.0f, 1.0f);
+
+	obs_transform_info transform = t < 1.0f ? a.transform : b.transform;
+	transform.pos.x = AnimationManager::Lerp(a.transform.pos.x, b.transform.pos.x, t);
+	transform.pos.y = AnimationManager::Lerp(a.transform.pos.y, b.transform.pos.y, t);
+	transform.rot = AnimationManager::Lerp(a.transform.rot, b.transform.rot, t);
+	transform.scale.x = AnimationManager::Lerp(a.transform.scale.x, b.transform.scale.x, t);
+	transform.scale.y = AnimationManager::Lerp(a.transform.scale.y, b.transform.scale.y, t);
+	transform.bounds.x = AnimationManager::Lerp(a.transform.bounds.x, b.transform.bounds.x, t);
+	transform.bounds.y = AnimationManager::Lerp(a.transform.bounds.y, b.transform.bounds.y, t);
+
+	obs_sceneitem_crop crop;
+	crop.left = LerpCrop(a.crop.left, b.crop.left, t);
+	crop.right = LerpCrop(a.crop.right, b.crop.right, t);
+	crop.top = LerpCrop(a.crop.top, b.crop.top, t);
+	crop.bottom = LerpCrop(a.crop.bottom, b.crop.bottom, t);
+
+	obs_sceneitem_set_info2(sceneItem, &transform);
+	obs_sceneitem_set_crop(sceneItem, &crop);
+}
+
+/**
+ * Animates the transform and crop info of a scene item over a duration.
+ *
+ * The animation is run by obs-websocket on every frame, so the client only has to send a single request.
+ * The `AnimationEnded` event is emitted once it completes or is cancelled. Starting another animation on the same scene item cancels the running one.
+ *
+ * The animation starts from the current transform of the scene item. Each keyframe contains a `sceneItemTransform` object like `SetSceneItemTransform`,
+ * which is applied on top of the previous keyframe, and an `offset` (0 to 1) within the duration at which it is reached.
+ * Numeric fields are interpolated between keyframes, other fields change once the keyframe is reached.
+ *
+ * Scenes and Groups
+ *
+ * @requestField ?canvasUuid         | String        | UUID of the canvas the scene is in, if using the sceneName field
+ * @requestField ?sceneName          | String        | Name of the scene the item is in
+ * @requestField ?sceneUuid          | String        | UUID of the scene the item is in
+ * @requestField sceneItemId         | Number        | Numeric ID of the scene item | >= 0
+ * @requestField duration            | Number        | Duration of the animation in milliseconds | >= 0, <= 3600000
+ * @requestField ?easing             | Number        | `AnimationEasing` curve applied to the progress of the whole animation | >= 0, <= 3 | `Linear`
+ * @requestField ?sceneItemTransform | Object        | Transform to animate to. Shorthand for a single keyframe with an offset of 1 | Unused if `keyframes` is set
+ * @requestField ?keyframes          | Array<Object> | Array of objects containing `offset` and `sceneItemTransform`, in increasing order of `offset`. The last keyframe must have an offset of 1 | Required if `sceneItemTransform` is not set
+ *
+ * @responseField animationId | Number | ID of the animation, to be used with `StopAnimation` and in the `AnimationEnded` event
+ *
+ * @requestType StartSceneItemAnimation
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category scene items
+ */
+RequestResult RequestHandler::StartSceneItemAnimation(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSceneItemAutoRelease sceneItem = request.AcquireSceneItem(statusCode, comment, OBS_WEBSOCKET_SCENE_FILTER_SCENE_OR_GROUP);
+	uint64_t duration;
+	AnimationEasing::AnimationEasing easing;
+	if (!(sceneItem && ValidateAnimation(request, duration, easing, statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	auto animationManager = GetAnimationManager();
+	if (!animationManager)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to start animation due to internal error.");
+
+	json keyframesJson;
+	if (request.Contains("keyframes")) {
+		if (!request.ValidateOptionalArray("keyframes", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+		keyframesJson = request.RequestData["keyframes"];
+	} else {
+		if (!request.ValidateObject("sceneItemTransform", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+		keyframesJson = json::array({{{"offset", 1}, {"sceneItemTransform", request.RequestData["sceneItemTransform"]}}});
+	}
+
+	// The first keyframe is the current transform, unless the request sets one at an offset of 0
+	SceneItemTransformUpdate update;
+	InitSceneItemTransformUpdate(sceneItem, update);
+	std::vector<SceneItemKeyframe> keyframes{{0.0f, update.transform, update.crop}};
+	for (size_t i = 0; i < keyframesJson.size(); i++) {
+		const json &keyframeJson = keyframesJson[i];
+		std::string prefix = "keyframes[" + std::to_string(i) + "]: ";
+
+		if (!keyframeJson.is_object() || !keyframeJson.contains("offset") || !keyframeJson["offset"].is_number() ||
+		    !keyframeJson.contains("sceneItemTransform") || !keyframeJson["sceneItemTransform"].is_object())
+			return RequestResult::Error(RequestStatus::InvalidRequestFieldType,
+						    prefix + "Must contain an `offset` number and a `sceneItemTransform` object.");
+
+		float offset = keyframeJson["offset"];
+		if (!(offset >= keyframes.back().offset && offset <= 1.0f) || (i > 0 && offset == keyframes.back().offset))
+			return RequestResult::Error(RequestStatus::RequestFieldOutOfRange,
+						    prefix + "The `offset` must be between the previous keyframe's offset and 1.");
+
+		if (!ParseSceneItemTransform(keyframeJson["sceneItemTransform"], update, statusCode, comment))
+			return RequestResult::Error(statusCode, prefix + comment);
+
+		if (offset == 0.0f)
+			keyframes[0] = {offset, update.transform, update.crop};
+		else
+			keyframes.push_back({offset, update.transform, update.crop});
+	}
+
+	if (keyframes.size() < 2 || keyframes.back().offset != 1.0f)
+		return RequestResult::Error(RequestStatus::InvalidRequestField, "The last keyframe must have an offset of 1.");
+
+	obs_source_t *sceneSource = obs_scene_get_source(obs_sceneitem_get_scene(sceneItem));
+	std::string sceneUuid = obs_source_get_uuid(sceneSource);
+	int64_t sceneItemId = obs_sceneitem_get_id(sceneItem);
+
+	json targetData;
+	targetData["sceneName"] = obs_source_get_name(sceneSource);
+	targetData["sceneUuid"] = sceneUuid;
+	targetData["sceneItemId"] = sceneItemId;
+
+	OBSSceneItem sceneItemRef = sceneItem.Get();
+	auto applyKeyframes = [sceneItemRef, keyframes](float progress) {
+		// Removed scene items no longer have a scene
+		if (!obs_sceneitem_get_scene(sceneItemRef))
+			return false;
+
+		ApplySceneItemKeyframes(sceneItemRef, keyframes, progress);
+		return true;
+	};
+
+	json responseData;
+	responseData["animationId"] = animationManager->Start(request.RequestType,
+							      "sceneItem:" + sceneUuid + ":" + std::to_string(sceneItemId),
+							      targetData, duration, easing, applyKeyframes);
+
+	return RequestResult::Success(responseData);
+}
+
 /**
  * Gets the enable state of a scene item.
  *
@@ -806,6 +1213,13 @@ RequestResult RequestHandler::SetSceneItemBlendMode(const Request &request)
 
 	obs_sceneitem_set_blending_mode(sceneItem, blendMode);
 
+	// Blend mode changes do not emit an event
+	auto eventHandler = GetEventHandler();
+	if (eventHandler) {
+		obs_source_t *sceneSource = obs_scene_get_source(obs_sceneitem_get_scene(sceneItem));
+		eventHandler->BumpResourceGeneration(std::string("sceneItems:") + obs_source_get_uuid(sceneSource));
+	}
+
 	return RequestResult::Success();
 }
 
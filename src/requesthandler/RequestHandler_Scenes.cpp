@@ -22,8 +22,11 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 /**
  * Gets an array of scenes in OBS.
  *
- * @requestField ?canvasUuid | String | UUID of the canvas the scenes are in
- * 
+ * @requestField ?canvasUuid  | String | UUID of the canvas the scenes are in
+ * @requestField ?ifNoneMatch | String | ETag of a previous response. If the scene list has not changed since, only `etag` and `notModified` are returned
+ *
+ * @responseField etag                    | String        | ETag of the scene list, to be used as `ifNoneMatch` of a later request
+ * @responseField notModified             | Boolean       | Only returned (as `true`) if `ifNoneMatch` is equal to the current ETag
  * @responseField currentProgramSceneName | String        | Current program scene name. Can be `null` if non-main canvas or internal state desync
  * @responseField currentProgramSceneUuid | String        | Current program scene UUID. Can be `null` if non-main canvas or internal state desync
  * @responseField currentPreviewSceneName | String        | Current preview scene name. `null` if not in studio mode or non-main canvas
@@ -45,7 +48,20 @@ RequestResult RequestHandler::GetSceneList(const Request &request)
 	if (!canvas)
 		return RequestResult::Error(statusCode, comment);
 
+	std::string canvasUuid = obs_canvas_get_uuid(canvas);
+	std::string etag = GetETag(request.RequestType, canvasUuid, {"sceneList"});
+	bool notModified;
+	if (!CheckETag(request, etag, notModified, statusCode, comment))
+		return RequestResult::Error(statusCode, comment);
+	if (notModified)
+		return RequestResult::NotModified(etag);
+
+	ResponseCache::Payload cachedResponse = GetCachedResponse(request, canvasUuid, etag);
+	if (cachedResponse)
+		return RequestResult::Success(*cachedResponse);
+
 	json responseData;
+	responseData["etag"] = etag;
 
 	if (obs_canvas_get_flags(canvas) & MAIN) { // Main canvas, which has a program scene, preview scene, and scene order
 		OBSSourceAutoRelease currentProgramScene = obs_frontend_get_current_scene();
@@ -74,6 +90,8 @@ RequestResult RequestHandler::GetSceneList(const Request &request)
 		responseData["scenes"] = Utils::Obs::ArrayHelper::GetCanvasSceneList(canvas);
 	}
 
+	CacheResponse(request, canvasUuid, etag, responseData);
+
 	return RequestResult::Success(responseData);
 }
 
@@ -17,96 +17,45 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
-#include <QBuffer>
-#include <QImageWriter>
+#include <QFile>
 #include <QFileInfo>
 #include <QImage>
 #include <QDir>
 
 #include "RequestHandler.h"
+#include "ScreenshotRenderer.h"
+#include "ScreenshotSaver.h"
+#include "ScreenshotStreamManager.h"
+#include "../utils/Image.h"
 
 QImage TakeSourceScreenshot(obs_source_t *source, bool &success, uint32_t requestedWidth = 0, uint32_t requestedHeight = 0)
 {
-	// Get info about the requested source
-	const uint32_t sourceWidth = obs_source_get_width(source);
-	const uint32_t sourceHeight = obs_source_get_height(source);
-	const double sourceAspectRatio = ((double)sourceWidth / (double)sourceHeight);
+	uint32_t imgWidth;
+	uint32_t imgHeight;
+	ScreenshotRenderer::GetImageSize(source, requestedWidth, requestedHeight, imgWidth, imgHeight);
 
-	uint32_t imgWidth = sourceWidth;
-	uint32_t imgHeight = sourceHeight;
-
-	// Determine suitable image width
-	if (requestedWidth) {
-		imgWidth = requestedWidth;
-
-		if (!requestedHeight)
-			imgHeight = ((double)imgWidth / sourceAspectRatio);
-	}
-
-	// Determine suitable image height
-	if (requestedHeight) {
-		imgHeight = requestedHeight;
-
-		if (!requestedWidth)
-			imgWidth = ((double)imgHeight * sourceAspectRatio);
-	}
-
-	// Create final image texture
-	QImage ret(imgWidth, imgHeight, QImage::Format::Format_RGBA8888);
-	ret.fill(0);
-
-	// Video image buffer
-	uint8_t *videoData = nullptr;
-	uint32_t videoLinesize = 0;
-
-	// Enter graphics context
-	obs_enter_graphics();
-
-	gs_texrender_t *texRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
-	gs_stagesurf_t *stageSurface = gs_stagesurface_create(imgWidth, imgHeight, GS_RGBA);
-
-	success = false;
-	gs_texrender_reset(texRender);
-	if (gs_texrender_begin(texRender, imgWidth, imgHeight)) {
-		vec4 background;
-		vec4_zero(&background);
-
-		gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
-		gs_ortho(0.0f, (float)sourceWidth, 0.0f, (float)sourceHeight, -100.0f, 100.0f);
-
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-		obs_source_inc_showing(source);
-		obs_source_video_render(source);
-		obs_source_dec_showing(source);
-
-		gs_blend_state_pop();
-		gs_texrender_end(texRender);
-
-		gs_stage_texture(stageSurface, gs_texrender_get_texture(texRender));
-		if (gs_stagesurface_map(stageSurface, &videoData, &videoLinesize)) {
-			int lineSize = ret.bytesPerLine();
-			for (uint y = 0; y < imgHeight; y++) {
-				memcpy(ret.scanLine(y), videoData + (y * videoLinesize), lineSize);
-			}
-			gs_stagesurface_unmap(stageSurface);
-			success = true;
-		}
-	}
-
-	gs_stagesurface_destroy(stageSurface);
-	gs_texrender_destroy(texRender);
-
-	obs_leave_graphics();
+	// Rendered and read back on the graphics tick, reusing pooled GPU resources
+	QImage ret;
+	auto screenshotRenderer = GetScreenshotRenderer();
+	// Requests from the plugin API may still arrive while the plugin is unloading
+	success = screenshotRenderer && screenshotRenderer->Render(source, imgWidth, imgHeight, ret);
 
 	return ret;
 }
 
 bool IsImageFormatValid(std::string format)
 {
-	QByteArrayList supportedFormats = QImageWriter::supportedImageFormats();
-	return supportedFormats.contains(format.c_str());
+	return Utils::Image::IsFormatSupported(format);
+}
+
+bool EncodeScreenshot(const QImage &image, const std::string &format, int quality, QByteArray &encodedImage)
+{
+	// Requests executed within the graphics tick (scheduled or frame-serial batches) would stall rendering while waiting
+	// for the encoder pool, so they encode on the graphics thread directly
+	if (obs_in_task_thread(OBS_TASK_GRAPHICS))
+		return Utils::Image::Encode(image, format, quality, encodedImage);
+
+	return Utils::Image::EncodeInPool(image, format, quality, encodedImage);
 }
 
 /**
@@ -151,17 +100,25 @@ RequestResult RequestHandler::GetSourceActive(const Request &request)
  * The `imageWidth` and `imageHeight` parameters are treated as "scale to inner", meaning the smallest ratio will be used and the aspect ratio of the original resolution is kept.
  * If `imageWidth` and `imageHeight` are not specified, the compressed image will use the full resolution of the source.
  *
+ * When `imageBinary` is true, `imageData` is a MsgPack `bin` value for MsgPack sessions. For Json sessions it is the size of the image in bytes,
+ * and the image itself follows the response as a binary message. This avoids the Base64 overhead of the default data URI.
+ *
+ * Besides the Qt image formats, `qoi` is a lossless format which encodes much faster than `png`, and `rgba` and `bgra` are uncompressed pixels, row by row.
+ *
  * **Compatible with inputs and scenes.**
  *
- * @requestField ?canvasUuid              | String | UUID of the canvas the source is in, if using sourceName field
- * @requestField ?sourceName              | String | Name of the source to take a screenshot of
- * @requestField ?sourceUuid              | String | UUID of the source to take a screenshot of
- * @requestField imageFormat              | String | Image compression format to use. Use `GetVersion` to get compatible image formats
- * @requestField ?imageWidth              | Number | Width to scale the screenshot to                                                                                         | >= 8, <= 4096 | Source value is used
- * @requestField ?imageHeight             | Number | Height to scale the screenshot to                                                                                        | >= 8, <= 4096 | Source value is used
- * @requestField ?imageCompressionQuality | Number | Compression quality to use. 0 for high compression, 100 for uncompressed. -1 to use "default" (whatever that means, idk) | >= -1, <= 100 | -1
+ * @requestField ?canvasUuid              | String  | UUID of the canvas the source is in, if using sourceName field
+ * @requestField ?sourceName              | String  | Name of the source to take a screenshot of
+ * @requestField ?sourceUuid              | String  | UUID of the source to take a screenshot of
+ * @requestField imageFormat              | String  | Image compression format to use. Use `GetVersion` to get compatible image formats
+ * @requestField ?imageWidth              | Number  | Width to scale the screenshot to                                                                                         | >= 8, <= 4096 | Source value is used
+ * @requestField ?imageHeight             | Number  | Height to scale the screenshot to                                                                                        | >= 8, <= 4096 | Source value is used
+ * @requestField ?imageCompressionQuality | Number  | Compression quality to use. 0 for high compression, 100 for uncompressed. -1 to use "default" (whatever that means, idk) | >= -1, <= 100 | -1
+ * @requestField ?imageBinary             | Boolean | Return the encoded image as binary data instead of a Base64 data URI | false
  *
- * @responseField imageData | String | Base64-encoded screenshot
+ * @responseField imageData   | String | Base64-encoded screenshot, or the encoded image as binary data if `imageBinary` is true
+ * @responseField imageWidth  | Number | Width of the screenshot, which is needed to decode the uncompressed `rgba` and `bgra` formats
+ * @responseField imageHeight | Number | Height of the screenshot
  *
  * @requestType GetSourceScreenshot
  * @complexity 4
@@ -212,6 +169,14 @@ RequestResult RequestHandler::GetSourceScreenshot(const Request &request)
 		compressionQuality = request.RequestData["imageCompressionQuality"];
 	}
 
+	bool imageBinary = false;
+	if (request.Contains("imageBinary")) {
+		if (!request.ValidateOptionalBoolean("imageBinary", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		imageBinary = request.RequestData["imageBinary"];
+	}
+
 	bool success;
 	QImage renderedImage = TakeSourceScreenshot(source, success, requestedWidth, requestedHeight);
 
@@ -219,17 +184,19 @@ RequestResult RequestHandler::GetSourceScreenshot(const Request &request)
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to render screenshot.");
 
 	QByteArray encodedImgBytes;
-	QBuffer buffer(&encodedImgBytes);
-	buffer.open(QBuffer::WriteOnly);
-
-	if (!renderedImage.save(&buffer, imageFormat.c_str(), compressionQuality))
+	if (!EncodeScreenshot(renderedImage, imageFormat, compressionQuality, encodedImgBytes))
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to encode screenshot.");
 
-	buffer.close();
+	json responseData;
+	responseData["imageWidth"] = renderedImage.width();
+	responseData["imageHeight"] = renderedImage.height();
+	if (imageBinary) {
+		responseData["imageData"] = json::binary(std::vector<uint8_t>(encodedImgBytes.begin(), encodedImgBytes.end()));
+		return RequestResult::Success(responseData);
+	}
 
 	QString encodedPicture = QString("data:image/%1;base64,").arg(imageFormat.c_str()).append(encodedImgBytes.toBase64());
 
-	json responseData;
 	responseData["imageData"] = encodedPicture.toStdString();
 	return RequestResult::Success(responseData);
 }
@@ -240,16 +207,24 @@ RequestResult RequestHandler::GetSourceScreenshot(const Request &request)
  * The `imageWidth` and `imageHeight` parameters are treated as "scale to inner", meaning the smallest ratio will be used and the aspect ratio of the original resolution is kept.
  * If `imageWidth` and `imageHeight` are not specified, the compressed image will use the full resolution of the source.
  *
+ * If `async` is set, the response is sent as soon as the screenshot has been rendered, with a `jobId`.
+ * The screenshot is then encoded and written in the background, and a `SourceScreenshotSaved` event with the same `jobId` is sent to this session once it is done.
+ * Only a limited number of screenshots can be saved in the background at once.
+ * The file is written to a temporary file first, so that the file at `imageFilePath` is never partially written.
+ *
  * **Compatible with inputs and scenes.**
  *
- * @requestField ?canvasUuid              | String | UUID of the canvas the source is in, if using sourceName field
- * @requestField ?sourceName              | String | Name of the source to take a screenshot of
- * @requestField ?sourceUuid              | String | UUID of the source to take a screenshot of
- * @requestField imageFormat              | String | Image compression format to use. Use `GetVersion` to get compatible image formats
- * @requestField imageFilePath            | String | Path to save the screenshot file to. Eg. `C:\Users\user\Desktop\screenshot.png`
- * @requestField ?imageWidth              | Number | Width to scale the screenshot to                                                                                         | >= 8, <= 4096 | Source value is used
- * @requestField ?imageHeight             | Number | Height to scale the screenshot to                                                                                        | >= 8, <= 4096 | Source value is used
- * @requestField ?imageCompressionQuality | Number | Compression quality to use. 0 for high compression, 100 for uncompressed. -1 to use "default" (whatever that means, idk) | >= -1, <= 100 | -1
+ * @requestField ?canvasUuid              | String  | UUID of the canvas the source is in, if using sourceName field
+ * @requestField ?sourceName              | String  | Name of the source to take a screenshot of
+ * @requestField ?sourceUuid              | String  | UUID of the source to take a screenshot of
+ * @requestField imageFormat              | String  | Image compression format to use. Use `GetVersion` to get compatible image formats
+ * @requestField imageFilePath            | String  | Path to save the screenshot file to. Eg. `C:\Users\user\Desktop\screenshot.png`
+ * @requestField ?imageWidth              | Number  | Width to scale the screenshot to                                                                                         | >= 8, <= 4096 | Source value is used
+ * @requestField ?imageHeight             | Number  | Height to scale the screenshot to                                                                                        | >= 8, <= 4096 | Source value is used
+ * @requestField ?imageCompressionQuality | Number  | Compression quality to use. 0 for high compression, 100 for uncompressed. -1 to use "default" (whatever that means, idk) | >= -1, <= 100 | -1
+ * @requestField ?async                   | Boolean | Respond once the screenshot is rendered, and save it in the background | false
+ *
+ * @responseField jobId | Number | ID of the save, matching the `SourceScreenshotSaved` event. Only included if `async` is set
  *
  * @requestType SaveSourceScreenshot
  * @complexity 3
@@ -306,20 +281,201 @@ RequestResult RequestHandler::SaveSourceScreenshot(const Request &request)
 		compressionQuality = request.RequestData["imageCompressionQuality"];
 	}
 
+	bool async = false;
+	if (request.Contains("async")) {
+		if (!request.ValidateOptionalBoolean("async", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		async = request.RequestData["async"];
+	}
+
 	bool success;
 	QImage renderedImage = TakeSourceScreenshot(source, success, requestedWidth, requestedHeight);
 
 	if (!success)
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to render screenshot.");
 
-	QString absoluteFilePath = filePathInfo.absoluteFilePath();
+	if (async) {
+		auto screenshotSaver = GetScreenshotSaver();
+		if (!screenshotSaver)
+			return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+						    "The screenshot saver is not available.");
+
+		uint64_t jobId = screenshotSaver->Save(_session, renderedImage, imageFormat, compressionQuality,
+						       filePathInfo.absoluteFilePath());
+		if (!jobId)
+			return RequestResult::Error(RequestStatus::NotEnoughResources,
+						    "Too many screenshots are already being saved.");
+
+		json responseData;
+		responseData["jobId"] = jobId;
+		return RequestResult::Success(responseData);
+	}
+
+	QByteArray encodedImgBytes;
+	if (!EncodeScreenshot(renderedImage, imageFormat, compressionQuality, encodedImgBytes))
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to encode screenshot.");
 
-	if (!renderedImage.save(absoluteFilePath, imageFormat.c_str(), compressionQuality))
+	QFile file(filePathInfo.absoluteFilePath());
+	if (!file.open(QIODevice::WriteOnly) || file.write(encodedImgBytes) != encodedImgBytes.size())
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to save screenshot.");
 
 	return RequestResult::Success();
 }
 
+/**
+ * Starts pushing screenshots of a set of sources to this session at a fixed interval, in `SourceScreenshotStreamFrame` events.
+ *
+ * All sources of all streams which are due on the same frame are rendered in one pass, and encoded in parallel.
+ * Each source is rendered once, at the largest resolution any stream needs, and scaled down on the CPU for the other streams.
+ * Streams of any session which use the same resolution, format and quality share the encode of a source.
+ * After the first frame, frames are due on multiples of the interval on the OBS clock, so streams with the same interval are rendered together.
+ * If the screenshots of an interval are not done by the next one, that interval is skipped.
+ *
+ * The image parameters behave like those of `GetSourceScreenshot`. The stream ends when this session disconnects.
+ *
+ * A stream can have up to 16 sources. Each session can run up to 8 streams, and up to 64 streams can run across all sessions.
+ *
+ * @requestField ?sourceNames             | Array<String> | Names of the sources to take screenshots of. Up to 16
+ * @requestField ?sourceUuids             | Array<String> | UUIDs of the sources to take screenshots of. Up to 16. Used instead of `sourceNames` if both are specified
+ * @requestField imageFormat              | String        | Image compression format to use. Use `GetVersion` to get compatible image formats
+ * @requestField interval                 | Number        | Interval between screenshots, in milliseconds                                                                            | >= 16, <= 60000
+ * @requestField ?imageWidth              | Number        | Width to scale the screenshots to                                                                                        | >= 8, <= 4096   | Source value is used
+ * @requestField ?imageHeight             | Number        | Height to scale the screenshots to                                                                                       | >= 8, <= 4096   | Source value is used
+ * @requestField ?imageCompressionQuality | Number        | Compression quality to use. 0 for high compression, 100 for uncompressed. -1 to use "default" (whatever that means, idk) | >= -1, <= 100   | -1
+ * @requestField ?imageBinary             | Boolean       | Send the encoded images as binary data instead of Base64 data URIs, like `GetSourceScreenshot` | false
+ *
+ * @responseField streamId | Number | ID of the stream, to be used with `StopSourceScreenshotStream`
+ *
+ * @requestType StartSourceScreenshotStream
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category sources
+ */
+RequestResult RequestHandler::StartSourceScreenshotStream(const Request &request)
+{
+	if (!_session)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Screenshot streams are only available to WebSocket sessions.");
+
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	std::string keyName = request.Contains("sourceUuids") ? "sourceUuids" : "sourceNames";
+	if (!(request.ValidateArray(keyName, statusCode, comment) && request.ValidateString("imageFormat", statusCode, comment) &&
+	      request.ValidateNumber("interval", statusCode, comment, 16, 60000)))
+		return RequestResult::Error(statusCode, comment);
+
+	ScreenshotStream stream;
+	stream.Session = _session;
+	stream.ImageFormat = request.RequestData["imageFormat"];
+	stream.Interval = request.RequestData["interval"].get<uint64_t>() * 1000000;
+
+	if (!IsImageFormatValid(stream.ImageFormat))
+		return RequestResult::Error(RequestStatus::InvalidRequestField,
+					    "Your specified image format is invalid or not supported by this system.");
+
+	// Checked before the sources are looked up, so that a huge array is rejected early
+	if (request.RequestData[keyName].size() > MAX_SCREENSHOT_STREAM_SOURCES)
+		return RequestResult::Error(RequestStatus::NotEnoughResources,
+					    "A screenshot stream can have at most " + std::to_string(MAX_SCREENSHOT_STREAM_SOURCES) +
+						    " sources.");
+
+	bool byUuid = keyName == "sourceUuids";
+	for (auto &sourceId : request.RequestData[keyName]) {
+		if (!sourceId.is_string())
+			return RequestResult::Error(RequestStatus::InvalidRequestFieldType,
+						    std::string("The field value of `") + keyName +
+							    "` must be an array of strings.");
+
+		std::string sourceIdString = sourceId;
+		OBSSourceAutoRelease source = byUuid ? obs_get_source_by_uuid(sourceIdString.c_str())
+						     : obs_get_source_by_name(sourceIdString.c_str());
+		if (!source)
+			return RequestResult::Error(RequestStatus::ResourceNotFound,
+						    std::string("No source was found by the ") + (byUuid ? "UUID" : "name") +
+							    " of `" + sourceIdString + "`.");
+
+		if (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT && obs_source_get_type(source) != OBS_SOURCE_TYPE_SCENE)
+			return RequestResult::Error(RequestStatus::InvalidResourceType,
+						    std::string("The source `") + sourceIdString + "` is not an input or a scene.");
+
+		stream.Sources.push_back(OBSGetWeakRef(source.Get()));
+	}
+
+	if (request.Contains("imageWidth")) {
+		if (!request.ValidateOptionalNumber("imageWidth", statusCode, comment, 8, 4096))
+			return RequestResult::Error(statusCode, comment);
+
+		stream.ImageWidth = request.RequestData["imageWidth"];
+	}
+
+	if (request.Contains("imageHeight")) {
+		if (!request.ValidateOptionalNumber("imageHeight", statusCode, comment, 8, 4096))
+			return RequestResult::Error(statusCode, comment);
+
+		stream.ImageHeight = request.RequestData["imageHeight"];
+	}
+
+	if (request.Contains("imageCompressionQuality")) {
+		if (!request.ValidateOptionalNumber("imageCompressionQuality", statusCode, comment, -1, 100))
+			return RequestResult::Error(statusCode, comment);
+
+		stream.ImageCompressionQuality = request.RequestData["imageCompressionQuality"];
+	}
+
+	if (request.Contains("imageBinary")) {
+		if (!request.ValidateOptionalBoolean("imageBinary", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		stream.ImageBinary = request.RequestData["imageBinary"];
+	}
+
+	auto screenshotStreamManager = GetScreenshotStreamManager();
+	if (!screenshotStreamManager)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to start screenshot stream due to internal error.");
+
+	uint64_t streamId = screenshotStreamManager->Start(std::move(stream));
+	if (!streamId)
+		return RequestResult::Error(RequestStatus::NotEnoughResources, "Too many screenshot streams are already running.");
+
+	json responseData;
+	responseData["streamId"] = streamId;
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Stops a screenshot stream started by this session with `StartSourceScreenshotStream`.
+ *
+ * @requestField streamId | Number | ID of the stream to stop | >= 1
+ *
+ * @requestType StopSourceScreenshotStream
+ * @complexity 2
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category sources
+ */
+RequestResult RequestHandler::StopSourceScreenshotStream(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!request.ValidateNumber("streamId", statusCode, comment, 1))
+		return RequestResult::Error(statusCode, comment);
+
+	auto screenshotStreamManager = GetScreenshotStreamManager();
+	if (!screenshotStreamManager)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
+					    "Unable to stop screenshot stream due to internal error.");
+
+	if (!screenshotStreamManager->Stop(request.RequestData["streamId"], _session))
+		return RequestResult::Error(RequestStatus::ResourceNotFound, "This session has no screenshot stream with that ID.");
+
+	return RequestResult::Success();
+}
+
 // Intentionally undocumented
 RequestResult RequestHandler::GetSourcePrivateSettings(const Request &request)
 {
@@ -20,6 +20,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <math.h>
 
 #include "RequestHandler.h"
+#include "AnimationManager.h"
 
 /**
  * Gets an array of all available transition kinds.
@@ -332,3 +333,74 @@ RequestResult RequestHandler::SetTBarPosition(const Request &request)
 
 	return RequestResult::Success();
 }
+
+/**
+ * Moves the TBar to a new position over a duration, like a manual transition.
+ *
+ * The motion is run by obs-websocket on every frame, so the client only has to send a single request.
+ * The `AnimationEnded` event is emitted once it completes or is cancelled. The motion is cancelled if studio mode is disabled.
+ *
+ * @requestField position | Number  | Position to move the TBar to | >= 0.0, <= 1.0
+ * @requestField duration | Number  | Duration of the motion in milliseconds | >= 0, <= 3600000
+ * @requestField ?easing  | Number  | `AnimationEasing` curve of the motion | >= 0, <= 3 | `Linear`
+ * @requestField ?release | Boolean | Whether to release the TBar once the motion completes | `true`
+ *
+ * @responseField animationId | Number | ID of the motion, to be used with `StopAnimation` and in the `AnimationEnded` event
+ *
+ * @requestType AnimateTBarPosition
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.8.0
+ * @api requests
+ * @category transitions
+ */
+RequestResult RequestHandler::AnimateTBarPosition(const Request &request)
+{
+	if (!obs_frontend_preview_program_mode_active())
+		return RequestResult::Error(RequestStatus::StudioModeNotActive);
+
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	uint64_t duration;
+	AnimationEasing::AnimationEasing easing;
+	if (!(request.ValidateNumber("position", statusCode, comment, 0.0, 1.0) &&
+	      ValidateAnimation(request, duration, easing, statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	bool release = true;
+	if (request.Contains("release")) {
+		if (!request.ValidateOptionalBoolean("release", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+		release = request.RequestData["release"];
+	}
+
+	OBSSourceAutoRelease transition = obs_frontend_get_current_transition();
+	if (!transition)
+		return RequestResult::Error(RequestStatus::InvalidResourceState,
+					    "OBS does not currently have a scene transition set."); // This should not happen!
+
+	auto animationManager = GetAnimationManager();
+	if (!animationManager)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Unable to start motion due to internal error.");
+
+	float startPosition = obs_frontend_get_tbar_position() / 1024.0f;
+	float endPosition = request.RequestData["position"];
+
+	auto applyPosition = [startPosition, endPosition, release](float progress) {
+		if (!obs_frontend_preview_program_mode_active())
+			return false;
+
+		float position = AnimationManager::Lerp(startPosition, endPosition, progress);
+		obs_frontend_set_tbar_position((int)round(position * 1024.0));
+
+		if (release && progress >= 1.0f)
+			obs_frontend_release_tbar();
+
+		return true;
+	};
+
+	json responseData;
+	responseData["animationId"] = animationManager->Start(request.RequestType, "tBar", nullptr, duration, easing, applyPosition);
+
+	return RequestResult::Success(responseData);
+}
@@ -0,0 +1,198 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <util/profiler.hpp>
+
+#include "RequestScheduler.h"
+#include "../obs-websocket.h"
+
+// Batches are held until their target, which may be far in the future, so the number waiting is bounded
+#define MAX_SCHEDULED_BATCHES 4096
+#define MAX_SCHEDULED_BATCHES_PER_SESSION 256
+
+static inline bool IsSameSession(const std::weak_ptr<WebSocketSession> &a, const std::weak_ptr<WebSocketSession> &b)
+{
+	return !a.owner_before(b) && !b.owner_before(a);
+}
+
+// Batches scheduled without a session never expire
+static inline bool IsSessionExpired(const std::weak_ptr<WebSocketSession> &session)
+{
+	return session.expired() && !IsSameSession(session, std::weak_ptr<WebSocketSession>());
+}
+
+RequestScheduler::RequestScheduler()
+{
+	obs_add_tick_callback(ObsTickCallback, this);
+}
+
+RequestScheduler::~RequestScheduler()
+{
+	obs_remove_tick_callback(ObsTickCallback, this);
+
+	std::lock_guard<std::mutex> lock(_batchesMutex);
+	if (!_batches.empty())
+		blog_debug("[RequestScheduler::~RequestScheduler] Dropping %zu scheduled request batches.", _batches.size());
+}
+
+uint64_t RequestScheduler::Schedule(ScheduledRequestBatch batch)
+{
+	std::lock_guard<std::mutex> lock(_batchesMutex);
+
+	if (_batches.size() >= MAX_SCHEDULED_BATCHES)
+		RemoveExpiredBatches();
+	if (_batches.size() >= MAX_SCHEDULED_BATCHES)
+		return 0;
+
+	size_t sessionBatches = std::count_if(_batches.begin(), _batches.end(), [&batch](const auto &entry) {
+		return IsSameSession(entry.second.Session, batch.Session);
+	});
+	if (sessionBatches >= MAX_SCHEDULED_BATCHES_PER_SESSION)
+		return 0;
+
+	uint64_t scheduleId = _nextScheduleId++;
+
+	if (batch.TargetIsTimestamp)
+		_timestampQueue.emplace(batch.Target, scheduleId);
+	else
+		_frameQueue.emplace(batch.Target, scheduleId);
+
+	_batches.emplace(scheduleId, std::move(batch));
+
+	return scheduleId;
+}
+
+bool RequestScheduler::Cancel(uint64_t scheduleId, SessionPtr session)
+{
+	std::lock_guard<std::mutex> lock(_batchesMutex);
+	auto it = _batches.find(scheduleId);
+	if (it == _batches.end() || it->second.Session.lock() != session)
+		return false;
+
+	_batches.erase(it);
+	CompactQueues();
+
+	return true;
+}
+
+// Batches of disconnected sessions have nobody to send their results to. Their queue entries are skipped like cancelled ones
+void RequestScheduler::RemoveExpiredBatches()
+{
+	for (auto it = _batches.begin(); it != _batches.end();) {
+		if (IsSessionExpired(it->second.Session))
+			it = _batches.erase(it);
+		else
+			++it;
+	}
+
+	CompactQueues();
+}
+
+// Must be called with the mutex held
+void RequestScheduler::CompactQueues()
+{
+	if (_frameQueue.size() + _timestampQueue.size() <= 2 * _batches.size())
+		return;
+
+	RemoveStaleEntries(_frameQueue);
+	RemoveStaleEntries(_timestampQueue);
+}
+
+void RequestScheduler::RemoveStaleEntries(Queue &queue)
+{
+	std::vector<QueueEntry> entries;
+	entries.reserve(queue.size());
+	for (; !queue.empty(); queue.pop())
+		if (_batches.count(queue.top().second))
+			entries.push_back(queue.top());
+
+	queue = Queue(std::greater<QueueEntry>(), std::move(entries));
+}
+
+void RequestScheduler::ObsTickCallback(void *param, float)
+{
+	static_cast<RequestScheduler *>(param)->Tick();
+}
+
+void RequestScheduler::PopDueBatches(Queue &queue, uint64_t now,
+				     std::vector<std::pair<uint64_t, ScheduledRequestBatch>> &dueBatches)
+{
+	while (!queue.empty() && queue.top().first <= now) {
+		uint64_t scheduleId = queue.top().second;
+		queue.pop();
+
+		auto it = _batches.find(scheduleId);
+		if (it == _batches.end())
+			continue;
+
+		if (IsSessionExpired(it->second.Session)) {
+			_batches.erase(it);
+			continue;
+		}
+
+		dueBatches.emplace_back(scheduleId, std::move(it->second));
+		_batches.erase(it);
+	}
+}
+
+void RequestScheduler::Tick()
+{
+	uint64_t frame = ++_frameCount;
+	// Timestamp of the frame being rendered, so that a batch always lands on the same frame regardless of tick jitter
+	uint64_t frameTimestamp = obs_get_video_frame_time();
+
+	std::vector<std::pair<uint64_t, ScheduledRequestBatch>> dueBatches;
+	{
+		std::lock_guard<std::mutex> lock(_batchesMutex);
+		if (_batches.empty())
+			return;
+
+		PopDueBatches(_frameQueue, frame, dueBatches);
+		PopDueBatches(_timestampQueue, frameTimestamp, dueBatches);
+	}
+
+	if (dueBatches.empty())
+		return;
+
+	ScopeProfiler prof{"obs_websocket_request_scheduler_tick"};
+
+	// Batches which are due on the same frame are executed in the order they were scheduled in
+	std::sort(dueBatches.begin(), dueBatches.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+	// Processed outside of the lock, as the requests may schedule or cancel other batches
+	for (auto &[scheduleId, batch] : dueBatches) {
+		// Null for batches scheduled without a session. The session may also have disconnected since it was popped
+		SessionPtr session = batch.Session.lock();
+		if (!session && IsSessionExpired(batch.Session))
+			continue;
+
+		std::vector<RequestResult> results = RequestBatchHandler::ProcessRequestBatchInTick(
+			session, batch.Batch->Requests, batch.Variables, batch.Batch->HaltOnFailure, batch.Batch->Atomic);
+
+		if (!_batchExecutedCallback)
+			continue;
+
+		json eventData;
+		eventData["scheduleId"] = scheduleId;
+		eventData["frame"] = frame;
+		eventData["frameTimestamp"] = frameTimestamp;
+		eventData["results"] = RequestBatchHandler::GetResultsJson(*batch.Batch, results);
+		_batchExecutedCallback(session, eventData);
+	}
+}
@@ -0,0 +1,83 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "RequestBatchHandler.h"
+
+// A stored request batch which is executed on a given frame or at a given time
+struct ScheduledRequestBatch {
+	// Frames are counted by the scheduler, timestamps use `os_gettime_ns()`
+	uint64_t Target = 0;
+	bool TargetIsTimestamp = false;
+	// Session which receives the results. Empty for batches scheduled through the plugin API
+	std::weak_ptr<WebSocketSession> Session;
+	RequestBatchTemplatePtr Batch;
+	json Variables;
+};
+
+// Executes request batches within the graphics tick of their target frame, so that they are not affected by network jitter
+class RequestScheduler {
+public:
+	// Callback when a scheduled batch has been executed. Called from the graphics thread, so it must be set before any
+	// batch is scheduled and is not changed afterwards
+	typedef std::function<void(SessionPtr, json)> BatchExecutedCallback; // SessionPtr session, json eventData
+	inline void SetBatchExecutedCallback(BatchExecutedCallback cb) { _batchExecutedCallback = cb; }
+
+	RequestScheduler();
+	~RequestScheduler();
+
+	// Returns the schedule ID, or 0 if too many batches are waiting.
+	// Batches with a target in the past are executed on the next frame
+	uint64_t Schedule(ScheduledRequestBatch batch);
+	// Returns false if no batch with the ID was scheduled by the session and is waiting to be executed
+	bool Cancel(uint64_t scheduleId, SessionPtr session);
+
+	// Number of frames rendered since the scheduler was created
+	inline uint64_t GetFrameCount() { return _frameCount; }
+
+private:
+	typedef std::pair<uint64_t, uint64_t> QueueEntry; // uint64_t target, uint64_t scheduleId
+	typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> Queue;
+
+	BatchExecutedCallback _batchExecutedCallback;
+
+	std::atomic<uint64_t> _frameCount = 0;
+
+	// Cancelled batches are only removed from `_batches`, and skipped once they reach the top of their queue. Their entries
+	// are dropped from the queues once they outnumber the waiting batches, see `CompactQueues()`
+	std::mutex _batchesMutex;
+	Queue _frameQueue;
+	Queue _timestampQueue;
+	std::unordered_map<uint64_t, ScheduledRequestBatch> _batches;
+	uint64_t _nextScheduleId = 1;
+
+	static void ObsTickCallback(void *param, float);
+	void Tick();
+	void PopDueBatches(Queue &queue, uint64_t now, std::vector<std::pair<uint64_t, ScheduledRequestBatch>> &dueBatches);
+	void RemoveExpiredBatches();
+	void CompactQueues();
+	void RemoveStaleEntries(Queue &queue);
+};
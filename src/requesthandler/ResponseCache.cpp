@@ -0,0 +1,64 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "ResponseCache.h"
+
+// Entries of removed resources are never looked up again, so the cache is emptied once it reaches this size
+#define RESPONSE_CACHE_MAX_ENTRIES 256
+
+static inline std::string GetKey(const std::string &requestType, const std::string &resourceId)
+{
+	return requestType + "|" + resourceId;
+}
+
+ResponseCache::Payload ResponseCache::Get(const std::string &requestType, const std::string &resourceId, const std::string &etag)
+{
+	// No ETag means that changes cannot be tracked
+	if (etag.empty())
+		return nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _entries.find(GetKey(requestType, resourceId));
+		if (it != _entries.end() && it->second.etag == etag) {
+			_hits++;
+			return it->second.responseData;
+		}
+	}
+
+	_misses++;
+	return nullptr;
+}
+
+ResponseCache::Payload ResponseCache::Put(const std::string &requestType, const std::string &resourceId, const std::string &etag,
+					  json responseData)
+{
+	auto payload = std::make_shared<const json>(std::move(responseData));
+	if (etag.empty())
+		return payload;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (_entries.size() >= RESPONSE_CACHE_MAX_ENTRIES)
+		_entries.clear();
+
+	Entry &entry = _entries[GetKey(requestType, resourceId)];
+	entry.etag = etag;
+	entry.responseData = payload;
+	return payload;
+}
@@ -0,0 +1,54 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../utils/Json.h"
+
+// Caches the responses of read requests, shared by all sessions. Entries are only valid for the ETag they were stored with,
+// so they are invalidated by the same events which change ETags.
+class ResponseCache {
+public:
+	// Cached responses are never modified, so they can be shared and read without holding the cache's lock
+	typedef std::shared_ptr<const json> Payload;
+
+	// Returns the response cached for the current ETag, or nullptr
+	Payload Get(const std::string &requestType, const std::string &resourceId, const std::string &etag);
+	// Returns the cached response
+	Payload Put(const std::string &requestType, const std::string &resourceId, const std::string &etag, json responseData);
+
+	inline uint64_t Hits() { return _hits; }
+	inline uint64_t Misses() { return _misses; }
+
+private:
+	struct Entry {
+		std::string etag;
+		Payload responseData;
+	};
+
+	std::mutex _mutex;
+	std::unordered_map<std::string, Entry> _entries;
+	std::atomic<uint64_t> _hits = 0;
+	std::atomic<uint64_t> _misses = 0;
+};
@@ -0,0 +1,301 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <util/profiler.hpp>
+
+#include "ScreenshotRenderer.h"
+#include "../obs-websocket.h"
+#include "../utils/Image.h"
+
+// Pool entries of resolutions which have not been used for this many ticks are destroyed
+#define SCREENSHOT_POOL_IDLE_TICKS 600
+// Seconds to wait for a screenshot before giving up
+#define SCREENSHOT_TIMEOUT_SECONDS 5
+
+ScreenshotRenderer::ScreenshotRenderer()
+{
+	obs_add_tick_callback(ObsTickCallback, this);
+}
+
+ScreenshotRenderer::~ScreenshotRenderer()
+{
+	obs_remove_tick_callback(ObsTickCallback, this);
+
+	// Fail any screenshot which is still in progress
+	std::vector<JobPtr> jobs;
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		jobs.swap(_pendingJobs);
+	}
+	// Staged surfaces are returned to the pool, so that they are destroyed along with it
+	for (auto &job : _stagedJobs) {
+		PoolEntry &entry = _pool[{job->width, job->height}];
+		entry.freeStageSurfaces.push_back(job->stageSurface);
+		entry.usedStageSurfaces--;
+		job->stageSurface = nullptr;
+		jobs.push_back(job);
+	}
+	_stagedJobs.clear();
+	CompleteJobs(jobs);
+
+	DestroyPool();
+}
+
+bool ScreenshotRenderer::Render(obs_source_t *source, uint32_t width, uint32_t height, QImage &image)
+{
+	auto job = std::make_shared<Job>();
+	job->source = OBSGetWeakRef(source);
+	job->width = width;
+	job->height = height;
+
+	// Requests executed within the graphics tick (scheduled or frame-serial batches) cannot wait for the next tick
+	if (obs_in_task_thread(OBS_TASK_GRAPHICS)) {
+		obs_enter_graphics();
+		StageJob(job);
+		if (job->stageSurface)
+			ReadStagedJob(job);
+		obs_leave_graphics();
+	} else {
+		std::unique_lock<std::mutex> lock(_jobsMutex);
+		_pendingJobs.push_back(job);
+		// Ticks stop once video is shut down. An abandoned job is still safe to finish, as the tick holds its own reference
+		auto timeout = std::chrono::seconds(SCREENSHOT_TIMEOUT_SECONDS);
+		if (!_jobsCondition.wait_for(lock, timeout, [&job] { return job->done; })) {
+			blog(LOG_WARNING, "[ScreenshotRenderer::Render] Timed out waiting for the graphics tick.");
+			return false;
+		}
+	}
+
+	if (job->success)
+		image = std::move(job->image);
+
+	return job->success;
+}
+
+void ScreenshotRenderer::RenderAsync(obs_source_t *source, uint32_t width, uint32_t height, RenderCallback callback)
+{
+	auto job = std::make_shared<Job>();
+	job->source = OBSGetWeakRef(source);
+	job->width = width;
+	job->height = height;
+	job->callback = std::move(callback);
+
+	std::lock_guard<std::mutex> lock(_jobsMutex);
+	_pendingJobs.push_back(job);
+}
+
+void ScreenshotRenderer::GetImageSize(obs_source_t *source, uint32_t requestedWidth, uint32_t requestedHeight, uint32_t &width,
+				      uint32_t &height)
+{
+	// Get info about the requested source
+	const uint32_t sourceWidth = obs_source_get_width(source);
+	const uint32_t sourceHeight = obs_source_get_height(source);
+	const double sourceAspectRatio = ((double)sourceWidth / (double)sourceHeight);
+
+	width = sourceWidth;
+	height = sourceHeight;
+
+	// Determine suitable image width
+	if (requestedWidth) {
+		width = requestedWidth;
+
+		if (!requestedHeight)
+			height = ((double)width / sourceAspectRatio);
+	}
+
+	// Determine suitable image height
+	if (requestedHeight) {
+		height = requestedHeight;
+
+		if (!requestedWidth)
+			width = ((double)height * sourceAspectRatio);
+	}
+}
+
+void ScreenshotRenderer::ObsTickCallback(void *param, float)
+{
+	static_cast<ScreenshotRenderer *>(param)->Tick();
+}
+
+void ScreenshotRenderer::Tick()
+{
+	_tickCount++;
+
+	std::vector<JobPtr> pendingJobs;
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		// Idle pool entries are only checked for every second or so while there is nothing else to do
+		if (_pendingJobs.empty() && _stagedJobs.empty() && (_pool.empty() || _tickCount % 64))
+			return;
+
+		pendingJobs.swap(_pendingJobs);
+	}
+
+	ScopeProfiler prof{"obs_websocket_screenshot_tick"};
+
+	// Jobs staged on the previous tick are read first, so that their stage surfaces can be reused right away
+	std::vector<JobPtr> stagedJobs;
+	stagedJobs.swap(_stagedJobs);
+
+	obs_enter_graphics();
+
+	for (auto &job : stagedJobs)
+		ReadStagedJob(job);
+
+	for (auto &job : pendingJobs)
+		StageJob(job);
+
+	EvictIdleEntries();
+
+	obs_leave_graphics();
+
+	// Jobs which failed to stage are done as well
+	for (auto &job : pendingJobs) {
+		if (job->stageSurface)
+			_stagedJobs.push_back(job);
+		else
+			stagedJobs.push_back(job);
+	}
+
+	CompleteJobs(stagedJobs);
+}
+
+void ScreenshotRenderer::CompleteJobs(std::vector<JobPtr> &jobs)
+{
+	if (jobs.empty())
+		return;
+
+	bool notify = false;
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		for (auto &job : jobs) {
+			job->done = true;
+			notify |= !job->callback;
+		}
+	}
+
+	if (notify)
+		_jobsCondition.notify_all();
+
+	for (auto &job : jobs)
+		if (job->callback)
+			job->callback(job->success, std::move(job->image));
+}
+
+void ScreenshotRenderer::StageJob(const JobPtr &job)
+{
+	OBSSourceAutoRelease source = obs_weak_source_get_source(job->source);
+	if (!source)
+		return;
+
+	const uint32_t sourceWidth = obs_source_get_width(source);
+	const uint32_t sourceHeight = obs_source_get_height(source);
+	if (!sourceWidth || !sourceHeight)
+		return;
+
+	PoolEntry &entry = _pool[{job->width, job->height}];
+	entry.lastUsedTick = _tickCount;
+	if (!entry.texRender)
+		entry.texRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
+	gs_texrender_reset(entry.texRender);
+	if (!gs_texrender_begin(entry.texRender, job->width, job->height))
+		return;
+
+	vec4 background;
+	vec4_zero(&background);
+
+	gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
+	gs_ortho(0.0f, (float)sourceWidth, 0.0f, (float)sourceHeight, -100.0f, 100.0f);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	obs_source_inc_showing(source);
+	obs_source_video_render(source);
+	obs_source_dec_showing(source);
+
+	gs_blend_state_pop();
+	gs_texrender_end(entry.texRender);
+
+	gs_stagesurf_t *stageSurface;
+	if (entry.freeStageSurfaces.empty()) {
+		stageSurface = gs_stagesurface_create(job->width, job->height, GS_RGBA);
+	} else {
+		stageSurface = entry.freeStageSurfaces.back();
+		entry.freeStageSurfaces.pop_back();
+	}
+	entry.usedStageSurfaces++;
+
+	// Only queues the copy. The surface is mapped on the next tick, once the GPU has finished with it
+	gs_stage_texture(stageSurface, gs_texrender_get_texture(entry.texRender));
+	job->stageSurface = stageSurface;
+}
+
+void ScreenshotRenderer::ReadStagedJob(const JobPtr &job)
+{
+	uint8_t *videoData = nullptr;
+	uint32_t videoLinesize = 0;
+	if (gs_stagesurface_map(job->stageSurface, &videoData, &videoLinesize)) {
+		job->image = QImage(job->width, job->height, QImage::Format::Format_RGBA8888);
+		Utils::Image::CopyRows(job->image.bits(), job->image.bytesPerLine(), videoData, videoLinesize,
+				       job->image.bytesPerLine(), job->height);
+		gs_stagesurface_unmap(job->stageSurface);
+		job->success = true;
+	}
+
+	PoolEntry &entry = _pool[{job->width, job->height}];
+	entry.freeStageSurfaces.push_back(job->stageSurface);
+	entry.usedStageSurfaces--;
+	job->stageSurface = nullptr;
+}
+
+void ScreenshotRenderer::EvictIdleEntries()
+{
+	for (auto it = _pool.begin(); it != _pool.end();) {
+		PoolEntry &entry = it->second;
+		if (entry.usedStageSurfaces || _tickCount - entry.lastUsedTick < SCREENSHOT_POOL_IDLE_TICKS) {
+			++it;
+			continue;
+		}
+
+		for (auto stageSurface : entry.freeStageSurfaces)
+			gs_stagesurface_destroy(stageSurface);
+		gs_texrender_destroy(entry.texRender);
+		it = _pool.erase(it);
+	}
+}
+
+void ScreenshotRenderer::DestroyPool()
+{
+	if (_pool.empty())
+		return;
+
+	// The graphics subsystem may already have been freed (along with everything created in it) when the plugin is unloaded
+	obs_enter_graphics();
+	if (gs_get_context()) {
+		for (auto &[resolution, entry] : _pool) {
+			for (auto stageSurface : entry.freeStageSurfaces)
+				gs_stagesurface_destroy(stageSurface);
+			gs_texrender_destroy(entry.texRender);
+		}
+	}
+	obs_leave_graphics();
+
+	_pool.clear();
+}
@@ -0,0 +1,87 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <QImage>
+#include <obs.hpp>
+
+// Renders source screenshots on the graphics tick. GPU resources are pooled per resolution, and a staged frame is only
+// mapped on the following tick, so that reading it back never stalls the graphics pipeline.
+class ScreenshotRenderer {
+public:
+	ScreenshotRenderer();
+	~ScreenshotRenderer();
+
+	// Called from the graphics thread once a screenshot has been read back, or has failed
+	typedef std::function<void(bool, QImage &&)> RenderCallback; // bool success, QImage image
+
+	// Blocks until the screenshot has been read back, which takes two ticks
+	bool Render(obs_source_t *source, uint32_t width, uint32_t height, QImage &image);
+	// Screenshots submitted before the same tick are rendered in the same graphics pass
+	void RenderAsync(obs_source_t *source, uint32_t width, uint32_t height, RenderCallback callback);
+
+	// Scales the source resolution to the requested size. A size of 0 is derived from the other, keeping the aspect ratio
+	static void GetImageSize(obs_source_t *source, uint32_t requestedWidth, uint32_t requestedHeight, uint32_t &width,
+				 uint32_t &height);
+
+private:
+	struct Job {
+		OBSWeakSource source;
+		uint32_t width;
+		uint32_t height;
+		gs_stagesurf_t *stageSurface = nullptr; // Set once staged
+		RenderCallback callback; // Called instead of notifying `_jobsCondition`
+
+		QImage image;
+		bool success = false;
+		bool done = false;
+	};
+	typedef std::shared_ptr<Job> JobPtr;
+
+	struct PoolEntry {
+		gs_texrender_t *texRender = nullptr;
+		std::vector<gs_stagesurf_t *> freeStageSurfaces;
+		size_t usedStageSurfaces = 0;
+		uint64_t lastUsedTick = 0;
+	};
+	typedef std::pair<uint32_t, uint32_t> Resolution;
+
+	// Jobs waiting to be rendered. Only the graphics thread accesses the staged jobs and the pool
+	std::mutex _jobsMutex;
+	std::condition_variable _jobsCondition;
+	std::vector<JobPtr> _pendingJobs;
+	std::vector<JobPtr> _stagedJobs;
+
+	std::map<Resolution, PoolEntry> _pool;
+	uint64_t _tickCount = 0;
+
+	static void ObsTickCallback(void *param, float);
+	void Tick();
+	void CompleteJobs(std::vector<JobPtr> &jobs);
+	void StageJob(const JobPtr &job);
+	void ReadStagedJob(const JobPtr &job);
+	void EvictIdleEntries();
+	void DestroyPool();
+};
@@ -0,0 +1,111 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <QSaveFile>
+#include <util/platform.h>
+
+#include "ScreenshotSaver.h"
+#include "../utils/Compat.h"
+#include "../utils/Image.h"
+#include "plugin-macros.generated.h"
+
+// Every pending save holds its full resolution image until it is encoded, so the number of them is bounded
+#define MAX_PENDING_SAVES 16
+
+ScreenshotSaver::ScreenshotSaver()
+{
+	// A single writer keeps concurrent saves from competing for the same disk
+	_writePool.setMaxThreadCount(1);
+}
+
+ScreenshotSaver::~ScreenshotSaver()
+{
+	// Screenshots which were already accepted are still saved. Encodes are waited for first, as they queue the writes.
+	// The WebSocket server has already been stopped at this point, so no events are sent for them
+	Utils::Image::GetEncoderPool()->waitForDone();
+	_writePool.waitForDone();
+}
+
+uint64_t ScreenshotSaver::Save(SessionPtr session, QImage image, const std::string &imageFormat, int imageCompressionQuality,
+			       const QString &filePath)
+{
+	if (_pendingSaves++ >= MAX_PENDING_SAVES) {
+		_pendingSaves--;
+		return 0;
+	}
+
+	uint64_t jobId = _nextJobId++;
+	std::weak_ptr<WebSocketSession> weakSession = session;
+
+	Utils::Image::GetEncoderPool()->start(Utils::Compat::CreateFunctionRunnable(
+		[this, weakSession, jobId, image, imageFormat, imageCompressionQuality, filePath]() {
+			uint64_t startTime = os_gettime_ns();
+			QByteArray encodedImage;
+			bool encoded = Utils::Image::Encode(image, imageFormat, imageCompressionQuality, encodedImage);
+			uint64_t encodeTime = os_gettime_ns() - startTime;
+
+			if (!encoded) {
+				EmitSaveCompleted(weakSession, jobId, filePath, "Failed to encode screenshot.", encodeTime, 0);
+				return;
+			}
+
+			_writePool.start(Utils::Compat::CreateFunctionRunnable(
+				[this, weakSession, jobId, encodedImage, filePath, encodeTime]() {
+					Write(weakSession, jobId, encodedImage, filePath, encodeTime);
+				}));
+		}));
+
+	return jobId;
+}
+
+void ScreenshotSaver::Write(std::weak_ptr<WebSocketSession> session, uint64_t jobId, QByteArray encodedImage,
+			    const QString &filePath, uint64_t encodeTime)
+{
+	uint64_t startTime = os_gettime_ns();
+
+	// Written to a temporary file which replaces the target once complete, so that a partial file is never visible
+	QSaveFile file(filePath);
+	bool written = file.open(QIODevice::WriteOnly) && file.write(encodedImage) == encodedImage.size() && file.commit();
+
+	uint64_t writeTime = os_gettime_ns() - startTime;
+
+	EmitSaveCompleted(session, jobId, filePath, written ? "" : "Failed to save screenshot.", encodeTime, writeTime);
+}
+
+void ScreenshotSaver::EmitSaveCompleted(std::weak_ptr<WebSocketSession> session, uint64_t jobId, const QString &filePath,
+					const std::string &error, uint64_t encodeTime, uint64_t writeTime)
+{
+	_pendingSaves--;
+
+	if (!error.empty())
+		blog(LOG_WARNING, "[ScreenshotSaver::EmitSaveCompleted] Job %llu: %s Path: %s", (unsigned long long)jobId,
+		     error.c_str(), filePath.toUtf8().constData());
+
+	if (!_saveCompletedCallback)
+		return;
+
+	json eventData;
+	eventData["jobId"] = jobId;
+	eventData["imageFilePath"] = filePath.toStdString();
+	eventData["success"] = error.empty();
+	if (!error.empty())
+		eventData["error"] = error;
+	eventData["encodeTime"] = encodeTime / 1000000.0;
+	eventData["writeTime"] = writeTime / 1000000.0;
+	_saveCompletedCallback(session.lock(), eventData);
+}
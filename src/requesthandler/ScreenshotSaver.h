@@ -0,0 +1,58 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <QImage>
+#include <QString>
+#include <QThreadPool>
+
+#include "../websocketserver/rpc/WebSocketSession.h"
+#include "../utils/Json.h"
+
+// Encodes and writes screenshots in the background, so that a slow disk does not hold up request processing
+class ScreenshotSaver {
+public:
+	// Callback when a screenshot has been written, or has failed to be. `session` is the session which saved it, or null
+	// if it was saved through the plugin API or the session has disconnected since
+	typedef std::function<void(SessionPtr, json)> SaveCompletedCallback; // SessionPtr session, json eventData
+	inline void SetSaveCompletedCallback(SaveCompletedCallback cb) { _saveCompletedCallback = cb; }
+
+	ScreenshotSaver();
+	~ScreenshotSaver();
+
+	// Returns the job ID, or 0 if too many screenshots are already being saved.
+	// Encoding runs on the encoder pool, writes are done one at a time in the order they were encoded in
+	uint64_t Save(SessionPtr session, QImage image, const std::string &imageFormat, int imageCompressionQuality,
+		      const QString &filePath);
+
+private:
+	SaveCompletedCallback _saveCompletedCallback;
+
+	QThreadPool _writePool;
+	std::atomic<uint64_t> _nextJobId = 1;
+	std::atomic<size_t> _pendingSaves = 0;
+
+	void Write(std::weak_ptr<WebSocketSession> session, uint64_t jobId, QByteArray encodedImage, const QString &filePath,
+		   uint64_t encodeTime);
+	void EmitSaveCompleted(std::weak_ptr<WebSocketSession> session, uint64_t jobId, const QString &filePath,
+			       const std::string &error, uint64_t encodeTime, uint64_t writeTime);
+};
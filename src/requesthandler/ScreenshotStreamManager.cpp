@@ -0,0 +1,283 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <util/profiler.hpp>
+
+#include "ScreenshotStreamManager.h"
+#include "ScreenshotRenderer.h"
+#include "../obs-websocket.h"
+#include "../utils/Compat.h"
+#include "../utils/Image.h"
+
+ScreenshotStreamManager::ScreenshotStreamManager() : _state(std::make_shared<State>())
+{
+	obs_add_tick_callback(ObsTickCallback, this);
+}
+
+ScreenshotStreamManager::~ScreenshotStreamManager()
+{
+	obs_remove_tick_callback(ObsTickCallback, this);
+
+	// Frames which are still being rendered are dropped once the renderer completes them
+	{
+		std::lock_guard<std::mutex> lock(_state->mutex);
+		_state->stopped = true;
+		_state->frameCallback = nullptr;
+		_state->streams.clear();
+	}
+
+	Utils::Image::GetEncoderPool()->waitForDone();
+}
+
+uint64_t ScreenshotStreamManager::Start(ScreenshotStream stream)
+{
+	if (stream.Sources.size() > MAX_SCREENSHOT_STREAM_SOURCES)
+		return 0;
+
+	SessionPtr session = stream.Session.lock();
+
+	std::lock_guard<std::mutex> lock(_state->mutex);
+
+	// Streams of disconnected sessions are only removed on the next tick, so they are not counted
+	size_t totalStreams = 0;
+	size_t sessionStreams = 0;
+	for (auto &[streamId, streamState] : _state->streams) {
+		SessionPtr streamSession = streamState.stream.Session.lock();
+		if (!streamSession)
+			continue;
+
+		totalStreams++;
+		if (streamSession == session)
+			sessionStreams++;
+	}
+	if (totalStreams >= MAX_SCREENSHOT_STREAMS || sessionStreams >= MAX_SCREENSHOT_STREAMS_PER_SESSION)
+		return 0;
+
+	uint64_t streamId = _nextStreamId++;
+
+	StreamState streamState;
+	streamState.stream = std::move(stream);
+	_state->streams.emplace(streamId, std::move(streamState));
+
+	return streamId;
+}
+
+bool ScreenshotStreamManager::Stop(uint64_t streamId, SessionPtr session)
+{
+	std::lock_guard<std::mutex> lock(_state->mutex);
+	auto it = _state->streams.find(streamId);
+	if (it == _state->streams.end() || it->second.stream.Session.lock() != session)
+		return false;
+
+	_state->streams.erase(it);
+	return true;
+}
+
+void ScreenshotStreamManager::ObsTickCallback(void *param, float)
+{
+	static_cast<ScreenshotStreamManager *>(param)->Tick();
+}
+
+void ScreenshotStreamManager::Tick()
+{
+	struct Render {
+		OBSSource source;
+		FramePtr frame;
+	};
+	std::vector<Render> renders;
+
+	uint64_t now = obs_get_video_frame_time();
+	{
+		std::lock_guard<std::mutex> lock(_state->mutex);
+		if (_state->streams.empty())
+			return;
+
+		for (auto it = _state->streams.begin(); it != _state->streams.end();) {
+			auto &[streamId, streamState] = *it;
+			if (streamState.stream.Session.expired()) {
+				it = _state->streams.erase(it);
+				continue;
+			}
+
+			// A stream whose last frames are not done yet skips the interval instead of queueing up more work
+			if (streamState.pendingFrames || streamState.nextFrameTime > now) {
+				++it;
+				continue;
+			}
+
+			// Frames are due on multiples of the interval, so that streams with the same interval are due on the same tick
+			// and share their renders and encodes, regardless of when they were started. Missed intervals are skipped.
+			uint64_t interval = streamState.stream.Interval;
+			streamState.nextFrameTime = (now / interval + 1) * interval;
+
+			const ScreenshotStream &stream = streamState.stream;
+			for (auto &weakSource : stream.Sources) {
+				OBSSourceAutoRelease source = obs_weak_source_get_source(weakSource);
+				if (!source)
+					continue;
+
+				uint32_t width;
+				uint32_t height;
+				ScreenshotRenderer::GetImageSize(source, stream.ImageWidth, stream.ImageHeight, width, height);
+				if (!width || !height)
+					continue;
+
+				// Streams which are due on the same tick share the render of a source, and encodes with identical
+				// parameters
+				auto render = std::find_if(renders.begin(), renders.end(), [&](const Render &existing) {
+					return existing.source.Get() == source.Get();
+				});
+				if (render == renders.end()) {
+					auto frame = std::make_shared<Frame>();
+					frame->sourceName = obs_source_get_name(source);
+					frame->sourceUuid = obs_source_get_uuid(source);
+					frame->renderWidth = 0;
+					frame->renderHeight = 0;
+					renders.push_back({source.Get(), frame});
+					render = renders.end() - 1;
+				}
+
+				// Rounding, or both of `imageWidth` and `imageHeight` being set, can make the widest size shorter than
+				// another one, so every size must fit in the render
+				FramePtr &frame = render->frame;
+				frame->renderWidth = std::max(frame->renderWidth, width);
+				frame->renderHeight = std::max(frame->renderHeight, height);
+
+				auto &encodes = frame->encodes;
+				auto encode = std::find_if(encodes.begin(), encodes.end(), [&](const Encode &existing) {
+					return existing.imageWidth == width && existing.imageHeight == height &&
+					       existing.imageFormat == stream.ImageFormat &&
+					       existing.imageCompressionQuality == stream.ImageCompressionQuality;
+				});
+				if (encode == encodes.end()) {
+					encodes.push_back({width, height, stream.ImageFormat, stream.ImageCompressionQuality, {}});
+					encode = encodes.end() - 1;
+				}
+
+				encode->streamIds.push_back(streamId);
+				streamState.pendingFrames++;
+			}
+
+			++it;
+		}
+	}
+
+	if (renders.empty())
+		return;
+
+	ScopeProfiler prof{"obs_websocket_screenshot_stream_tick"};
+
+	// Everything submitted here is rendered in the same pass of the screenshot renderer
+	auto screenshotRenderer = GetScreenshotRenderer();
+	for (auto &render : renders) {
+		if (!screenshotRenderer) {
+			OnFrameRendered(_state, render.frame, false, QImage());
+			continue;
+		}
+
+		screenshotRenderer->RenderAsync(render.source, render.frame->renderWidth, render.frame->renderHeight,
+						[state = _state, frame = render.frame](bool success, QImage &&image) {
+							OnFrameRendered(state, frame, success, std::move(image));
+						});
+	}
+}
+
+void ScreenshotStreamManager::OnFrameRendered(const StatePtr &state, const FramePtr &frame, bool success, QImage &&image)
+{
+	if (!success) {
+		for (auto &encode : frame->encodes)
+			EndFrame(state, encode.streamIds);
+		return;
+	}
+
+	// QImage is implicitly shared, so every encode task reads the same pixels
+	std::lock_guard<std::mutex> lock(state->mutex);
+	if (state->stopped)
+		return;
+
+	for (auto &encode : frame->encodes)
+		Utils::Image::GetEncoderPool()->start(Utils::Compat::CreateFunctionRunnable(
+			[state, frame, &encode, image]() { EncodeFrame(state, frame, encode, image); }));
+}
+
+void ScreenshotStreamManager::EncodeFrame(const StatePtr &state, const FramePtr &frame, const Encode &encode, const QImage &image)
+{
+	// Encodes of the same smaller size in different formats each scale the image down, which keeps them parallel
+	QImage scaledImage = image;
+	if ((uint32_t)image.width() != encode.imageWidth || (uint32_t)image.height() != encode.imageHeight)
+		scaledImage = Utils::Image::Downscale(image, encode.imageWidth, encode.imageHeight);
+
+	QByteArray encodedImgBytes;
+	bool encoded = Utils::Image::Encode(scaledImage, encode.imageFormat, encode.imageCompressionQuality, encodedImgBytes);
+
+	if (!encoded)
+		blog_debug("[ScreenshotStreamManager::EncodeFrame] Failed to encode screenshot of source `%s`.",
+			   frame->sourceName.c_str());
+
+	std::string encodedPicture; // Only built if a stream needs it
+	for (uint64_t streamId : encode.streamIds) {
+		SessionPtr session;
+		bool imageBinary;
+		FrameCallback frameCallback;
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			auto it = state->streams.find(streamId);
+			if (it == state->streams.end())
+				continue;
+
+			session = it->second.stream.Session.lock();
+			imageBinary = it->second.stream.ImageBinary;
+			frameCallback = state->frameCallback;
+		}
+
+		if (!encoded || !session || !frameCallback)
+			continue;
+
+		json eventData;
+		eventData["streamId"] = streamId;
+		eventData["sourceName"] = frame->sourceName;
+		eventData["sourceUuid"] = frame->sourceUuid;
+		eventData["imageWidth"] = encode.imageWidth;
+		eventData["imageHeight"] = encode.imageHeight;
+		if (imageBinary) {
+			eventData["imageData"] = json::binary(std::vector<uint8_t>(encodedImgBytes.begin(), encodedImgBytes.end()));
+		} else {
+			if (encodedPicture.empty())
+				encodedPicture = QString("data:image/%1;base64,")
+							 .arg(encode.imageFormat.c_str())
+							 .append(encodedImgBytes.toBase64())
+							 .toStdString();
+			eventData["imageData"] = encodedPicture;
+		}
+
+		frameCallback(session, std::move(eventData));
+	}
+
+	EndFrame(state, encode.streamIds);
+}
+
+void ScreenshotStreamManager::EndFrame(const StatePtr &state, const std::vector<uint64_t> &streamIds)
+{
+	std::lock_guard<std::mutex> lock(state->mutex);
+	for (uint64_t streamId : streamIds) {
+		auto it = state->streams.find(streamId);
+		if (it != state->streams.end() && it->second.pendingFrames)
+			it->second.pendingFrames--;
+	}
+}
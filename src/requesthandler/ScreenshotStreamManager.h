@@ -0,0 +1,114 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <QImage>
+#include <obs.hpp>
+
+#include "../websocketserver/rpc/WebSocketSession.h"
+#include "../utils/Json.h"
+
+// Every source of a running stream is rendered and encoded on each of its intervals, so the work of streams is bounded
+#define MAX_SCREENSHOT_STREAMS 64
+#define MAX_SCREENSHOT_STREAMS_PER_SESSION 8
+#define MAX_SCREENSHOT_STREAM_SOURCES 16
+
+// Screenshots of a set of sources which are pushed to a session at a fixed interval
+struct ScreenshotStream {
+	std::weak_ptr<WebSocketSession> Session;
+	std::vector<OBSWeakSource> Sources;
+	uint32_t ImageWidth = 0; // 0 keeps the aspect ratio, like `GetSourceScreenshot`
+	uint32_t ImageHeight = 0;
+	std::string ImageFormat;
+	int ImageCompressionQuality = -1;
+	bool ImageBinary = false;
+	uint64_t Interval = 0; // Nanoseconds
+};
+
+// Renders the sources of all streams which are due in one graphics pass, then encodes them in parallel on the encoder
+// pool. Each source is rendered once, at the largest resolution any stream needs; smaller resolutions are scaled down
+// on the CPU. Encodes with identical parameters are shared between streams.
+class ScreenshotStreamManager {
+public:
+	// Callback for every encoded frame of a stream
+	typedef std::function<void(SessionPtr, json)> FrameCallback; // SessionPtr session, json eventData
+	inline void SetFrameCallback(FrameCallback cb)
+	{
+		std::lock_guard<std::mutex> lock(_state->mutex);
+		_state->frameCallback = cb;
+	}
+
+	ScreenshotStreamManager();
+	~ScreenshotStreamManager();
+
+	// Returns the stream ID, or 0 if the stream has too many sources or too many streams are running.
+	// The first frame is rendered on the next tick
+	uint64_t Start(ScreenshotStream stream);
+	// Returns false if the session has no stream with the ID
+	bool Stop(uint64_t streamId, SessionPtr session);
+
+private:
+	struct StreamState {
+		ScreenshotStream stream;
+		uint64_t nextFrameTime = 0;
+		size_t pendingFrames = 0; // Frames of the last interval which are still being rendered or encoded
+	};
+
+	// Shared with render callbacks and encode tasks, which may outlive the manager
+	struct State {
+		std::mutex mutex;
+		bool stopped = false;
+		FrameCallback frameCallback;
+		std::map<uint64_t, StreamState> streams;
+	};
+	typedef std::shared_ptr<State> StatePtr;
+
+	struct Encode {
+		uint32_t imageWidth;
+		uint32_t imageHeight;
+		std::string imageFormat;
+		int imageCompressionQuality;
+		std::vector<uint64_t> streamIds;
+	};
+
+	// One render of a source, and every encode needed from it
+	struct Frame {
+		std::string sourceName;
+		std::string sourceUuid;
+		uint32_t renderWidth;
+		uint32_t renderHeight;
+		std::vector<Encode> encodes;
+	};
+	typedef std::shared_ptr<Frame> FramePtr;
+
+	StatePtr _state;
+	uint64_t _nextStreamId = 1;
+
+	static void ObsTickCallback(void *param, float);
+	void Tick();
+	static void OnFrameRendered(const StatePtr &state, const FramePtr &frame, bool success, QImage &&image);
+	static void EncodeFrame(const StatePtr &state, const FramePtr &frame, const Encode &encode, const QImage &image);
+	static void EndFrame(const StatePtr &state, const std::vector<uint64_t> &streamIds);
+};
@@ -20,20 +20,12 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "Request.h"
 #include "../../obs-websocket.h"
 
-json GetDefaultJsonObject(const json &requestData)
-{
-	// Always provide an object to prevent exceptions while running checks in requests
-	if (!requestData.is_object())
-		return json::object();
-	else
-		return requestData;
-}
-
-Request::Request(const std::string &requestType, const json &requestData,
+Request::Request(const std::string &requestType, json requestData,
 		 const RequestBatchExecutionType::RequestBatchExecutionType executionType)
 	: RequestType(requestType),
 	  HasRequestData(requestData.is_object()),
-	  RequestData(GetDefaultJsonObject(requestData)),
+	  // Always provide an object to prevent exceptions while running checks in requests
+	  RequestData(HasRequestData ? std::move(requestData) : json::object()),
 	  ExecutionType(executionType)
 {
 }
@@ -211,6 +203,34 @@ bool Request::ValidateArray(const std::string &keyName, RequestStatus::RequestSt
 	return true;
 }
 
+bool Request::ValidateResponseFields(const std::unordered_set<std::string> &validFields, Utils::Obs::FieldSelector &fields,
+				     RequestStatus::RequestStatus &statusCode, std::string &comment) const
+{
+	if (!Contains("responseFields"))
+		return true;
+
+	if (!ValidateOptionalArray("responseFields", statusCode, comment))
+		return false;
+
+	for (auto &field : RequestData["responseFields"]) {
+		if (!field.is_string() || field.get<std::string>().empty()) {
+			statusCode = RequestStatus::InvalidRequestFieldType;
+			comment = "The field value of `responseFields` must be an array of non-empty strings.";
+			return false;
+		}
+
+		if (!validFields.count(field.get<std::string>())) {
+			statusCode = RequestStatus::InvalidRequestField;
+			comment = "`responseFields` contains the unknown field `" + field.get<std::string>() + "`.";
+			return false;
+		}
+
+		fields.Fields.insert(field.get<std::string>());
+	}
+
+	return true;
+}
+
 obs_canvas_t *Request::AcquireCanvas(const std::string &uuidKeyName, RequestStatus::RequestStatus &statusCode,
 				 std::string &comment) const
 {
@@ -22,6 +22,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "../types/RequestStatus.h"
 #include "../types/RequestBatchExecutionType.h"
 #include "../../utils/Json.h"
+#include "../../utils/Obs.h"
 
 enum ObsWebSocketSceneFilter {
 	OBS_WEBSOCKET_SCENE_FILTER_SCENE_ONLY,
@@ -36,7 +37,8 @@ struct FilterPair {
 };
 
 struct Request {
-	Request(const std::string &requestType, const json &requestData = nullptr,
+	// `requestData` is taken by value so that callers which no longer need it can move it in
+	Request(const std::string &requestType, json requestData = nullptr,
 		const RequestBatchExecutionType::RequestBatchExecutionType executionType = RequestBatchExecutionType::None);
 
 	// Contains the key and is not null
@@ -62,6 +64,10 @@ struct Request {
 				   const bool allowEmpty = false) const;
 	bool ValidateArray(const std::string &keyName, RequestStatus::RequestStatus &statusCode, std::string &comment,
 			   const bool allowEmpty = false) const;
+	// Fills `fields` from the optional `responseFields` array. `fields` is left empty (all fields) if it is not set.
+	// Fails if a field is not one of `validFields`
+	bool ValidateResponseFields(const std::unordered_set<std::string> &validFields, Utils::Obs::FieldSelector &fields,
+				    RequestStatus::RequestStatus &statusCode, std::string &comment) const;
 
 	// All return values have incremented refcounts
 	obs_canvas_t *AcquireCanvas(const std::string &uuidKeyName, RequestStatus::RequestStatus &statusCode,
@@ -83,4 +89,7 @@ struct Request {
 	bool HasRequestData;
 	json RequestData;
 	RequestBatchExecutionType::RequestBatchExecutionType ExecutionType;
+	// Encodings in which obs_data may be returned in `RequestResult::ResponseRawFields`. Only set for requests whose
+	// response is encoded and sent as-is, since nothing else can read the raw fields
+	uint8_t RawFieldEncodings = 0;
 };
@@ -21,10 +21,13 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "Request.h"
 
 struct RequestBatchRequest : Request {
-	RequestBatchRequest(const std::string &requestType, const json &requestData,
-			    RequestBatchExecutionType::RequestBatchExecutionType executionType,
-			    const json &inputVariables = nullptr, const json &outputVariables = nullptr);
+	RequestBatchRequest(const std::string &requestType, json requestData,
+			    RequestBatchExecutionType::RequestBatchExecutionType executionType, json inputVariables = nullptr,
+			    json outputVariables = nullptr, json condition = nullptr, json repeat = nullptr);
 
 	json InputVariables;
 	json OutputVariables;
+	// Batch control flow. Validated by the batch handler when the request is reached
+	json Condition;
+	json Repeat;
 };
@@ -36,3 +36,11 @@ RequestResult RequestResult::Error(RequestStatus::RequestStatus statusCode, std:
 {
 	return RequestResult(statusCode, nullptr, comment);
 }
+
+RequestResult RequestResult::NotModified(const std::string &etag)
+{
+	json responseData;
+	responseData["etag"] = etag;
+	responseData["notModified"] = true;
+	return RequestResult(RequestStatus::Success, responseData, "");
+}
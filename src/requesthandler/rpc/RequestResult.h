@@ -27,8 +27,12 @@ struct RequestResult {
 		      std::string comment = "");
 	static RequestResult Success(json responseData = nullptr);
 	static RequestResult Error(RequestStatus::RequestStatus statusCode, std::string comment = "");
+	// Response to a read request whose `ifNoneMatch` is equal to the current ETag
+	static RequestResult NotModified(const std::string &etag);
 	RequestStatus::RequestStatus StatusCode;
 	json ResponseData;
+	// Written into `ResponseData` when it is encoded. See `Request::RawFieldEncodings`
+	Utils::Json::RawFields ResponseRawFields;
 	std::string Comment;
 	size_t SleepFrames;
 };
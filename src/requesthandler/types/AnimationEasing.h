@@ -0,0 +1,96 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+namespace AnimationEasing {
+	enum AnimationEasing : uint8_t {
+		/**
+		* Constant speed from start to end.
+		*
+		* @enumIdentifier Linear
+		* @enumValue 0
+		* @enumType AnimationEasing
+		* @rpcVersion -1
+		* @initialVersion 5.8.0
+		* @api enums
+		*/
+		Linear = 0,
+		/**
+		* Starts slow and speeds up (cubic).
+		*
+		* @enumIdentifier EaseIn
+		* @enumValue 1
+		* @enumType AnimationEasing
+		* @rpcVersion -1
+		* @initialVersion 5.8.0
+		* @api enums
+		*/
+		EaseIn = 1,
+		/**
+		* Starts fast and slows down (cubic).
+		*
+		* @enumIdentifier EaseOut
+		* @enumValue 2
+		* @enumType AnimationEasing
+		* @rpcVersion -1
+		* @initialVersion 5.8.0
+		* @api enums
+		*/
+		EaseOut = 2,
+		/**
+		* Starts slow, speeds up, then slows down again (cubic).
+		*
+		* @enumIdentifier EaseInOut
+		* @enumValue 3
+		* @enumType AnimationEasing
+		* @rpcVersion -1
+		* @initialVersion 5.8.0
+		* @api enums
+		*/
+		EaseInOut = 3,
+	};
+
+	inline bool IsValid(uint8_t easing)
+	{
+		return easing <= EaseInOut;
+	}
+
+	// Maps linear progress (0 to 1) onto the curve
+	inline float Apply(AnimationEasing easing, float t)
+	{
+		switch (easing) {
+		case EaseIn:
+			return t * t * t;
+		case EaseOut: {
+			float u = 1.0f - t;
+			return 1.0f - u * u * u;
+		}
+		case EaseInOut: {
+			if (t < 0.5f)
+				return 4.0f * t * t * t;
+			float u = -2.0f * t + 2.0f;
+			return 1.0f - u * u * u / 2.0f;
+		}
+		default:
+			return t;
+		}
+	}
+}
@@ -53,6 +53,9 @@ namespace RequestBatchExecutionType {
 		*
 		* Note: To introduce artificial delay, use the `Sleep` request and the `sleepFrames` request field.
 		*
+		* Note: If the server has a per-frame request or time budget configured, requests which do not fit into the budget of
+		* a frame are processed on the following frames.
+		*
 		* @enumIdentifier SerialFrame
 		* @enumValue 1
 		* @enumType RequestBatchExecutionType
@@ -116,6 +116,19 @@ namespace RequestStatus {
 		* @api enums
 		*/
 		NotReady = 207,
+		/**
+		* The request was not processed because its batch `condition` was not met.
+		*
+		* Note: Skipped requests do not halt a batch with `haltOnFailure` enabled.
+		*
+		* @enumIdentifier RequestSkipped
+		* @enumValue 208
+		* @enumType RequestStatus
+		* @rpcVersion -1
+		* @initialVersion 5.8.0
+		* @api enums
+		*/
+		RequestSkipped = 208,
 
 		/**
 		* A required request field is missing.
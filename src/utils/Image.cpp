@@ -0,0 +1,420 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <map>
+#include <mutex>
+#include <QBuffer>
+#include <QImageWriter>
+#include <QThread>
+#include <util/platform.h>
+#include <util/sse-intrin.h>
+
+#include "Image.h"
+#include "Compat.h"
+#include "plugin-macros.generated.h"
+
+struct EncoderStats {
+	uint64_t encodedImages = 0;
+	uint64_t totalEncodeTime = 0; // Nanoseconds
+	uint64_t totalEncodedBytes = 0;
+};
+
+static std::mutex encoderStatsMutex;
+static std::map<std::string, EncoderStats> encoderStats;
+
+// https://qoiformat.org/qoi-specification.pdf
+static void EncodeQoi(const QImage &image, QByteArray &encodedImage)
+{
+	const uint32_t width = image.width();
+	const uint32_t height = image.height();
+
+	encodedImage.clear();
+	encodedImage.reserve(14 + width * height + 8); // Typical size for screenshots, grows if needed
+
+	auto pushUint32 = [&encodedImage](uint32_t value) {
+		encodedImage.append((char)(value >> 24));
+		encodedImage.append((char)(value >> 16));
+		encodedImage.append((char)(value >> 8));
+		encodedImage.append((char)value);
+	};
+
+	encodedImage.append("qoif", 4);
+	pushUint32(width);
+	pushUint32(height);
+	encodedImage.append((char)4); // RGBA
+	encodedImage.append((char)0); // sRGB with linear alpha
+
+	uint8_t index[64][4] = {};
+	uint8_t previous[4] = {0, 0, 0, 255};
+	int run = 0;
+
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t *line = image.constScanLine(y);
+		for (uint32_t x = 0; x < width; x++) {
+			const uint8_t *pixel = line + x * 4;
+			bool lastPixel = (y == height - 1) && (x == width - 1);
+
+			if (!memcmp(pixel, previous, 4)) {
+				run++;
+				if (run == 62 || lastPixel) {
+					encodedImage.append((char)(0xc0 | (run - 1))); // QOI_OP_RUN
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run) {
+				encodedImage.append((char)(0xc0 | (run - 1)));
+				run = 0;
+			}
+
+			int indexPosition = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+			if (!memcmp(index[indexPosition], pixel, 4)) {
+				encodedImage.append((char)indexPosition); // QOI_OP_INDEX
+			} else {
+				memcpy(index[indexPosition], pixel, 4);
+
+				if (pixel[3] == previous[3]) {
+					int8_t vr = pixel[0] - previous[0];
+					int8_t vg = pixel[1] - previous[1];
+					int8_t vb = pixel[2] - previous[2];
+					int8_t vgR = vr - vg;
+					int8_t vgB = vb - vg;
+
+					if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+						// QOI_OP_DIFF
+						encodedImage.append((char)(0x40 | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+					} else if (vgR > -9 && vgR < 8 && vg > -33 && vg < 32 && vgB > -9 && vgB < 8) {
+						encodedImage.append((char)(0x80 | (vg + 32))); // QOI_OP_LUMA
+						encodedImage.append((char)((vgR + 8) << 4 | (vgB + 8)));
+					} else {
+						encodedImage.append((char)0xfe); // QOI_OP_RGB
+						encodedImage.append((const char *)pixel, 3);
+					}
+				} else {
+					encodedImage.append((char)0xff); // QOI_OP_RGBA
+					encodedImage.append((const char *)pixel, 4);
+				}
+			}
+
+			memcpy(previous, pixel, 4);
+		}
+	}
+
+	static const char endMarker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+	encodedImage.append(endMarker, 8);
+}
+
+static void EncodeRaw(const QImage &image, bool bgra, QByteArray &encodedImage)
+{
+	// Rows of 32-bit images are never padded
+	const size_t pixels = (size_t)image.width() * image.height();
+
+	encodedImage.resize(pixels * 4);
+	uint8_t *out = (uint8_t *)encodedImage.data();
+	if (bgra)
+		Utils::Image::SwizzleRedBlue(out, image.constBits(), pixels);
+	else
+		memcpy(out, image.constBits(), pixels * 4);
+}
+
+// Averages 2x2 blocks of two rows into one row of `dstWidth` pixels
+static void HalveRows(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, uint32_t dstWidth)
+{
+	uint32_t x = 0;
+	for (; x + 4 <= dstWidth; x += 4) {
+		const uint8_t *s0 = row0 + x * 8;
+		const uint8_t *s1 = row1 + x * 8;
+		__m128i left = _mm_avg_epu8(_mm_loadu_si128((const __m128i *)s0), _mm_loadu_si128((const __m128i *)s1));
+		__m128i right =
+			_mm_avg_epu8(_mm_loadu_si128((const __m128i *)(s0 + 16)), _mm_loadu_si128((const __m128i *)(s1 + 16)));
+
+		// Splits the vertically averaged pixels into even and odd columns, which are then averaged with each other
+		__m128 leftPs = _mm_castsi128_ps(left);
+		__m128 rightPs = _mm_castsi128_ps(right);
+		__m128i even = _mm_castps_si128(_mm_shuffle_ps(leftPs, rightPs, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i odd = _mm_castps_si128(_mm_shuffle_ps(leftPs, rightPs, _MM_SHUFFLE(3, 1, 3, 1)));
+		_mm_storeu_si128((__m128i *)(dst + x * 4), _mm_avg_epu8(even, odd));
+	}
+
+	for (; x < dstWidth; x++) {
+		const uint8_t *s0 = row0 + x * 8;
+		const uint8_t *s1 = row1 + x * 8;
+		for (int c = 0; c < 4; c++)
+			dst[x * 4 + c] = (s0[c] + s0[4 + c] + s1[c] + s1[4 + c] + 2) / 4;
+	}
+}
+
+static QImage Halve(const QImage &image)
+{
+	QImage ret(image.width() / 2, image.height() / 2, QImage::Format_RGBA8888);
+	for (int y = 0; y < ret.height(); y++)
+		HalveRows(ret.scanLine(y), image.constScanLine(y * 2), image.constScanLine(y * 2 + 1), ret.width());
+
+	return ret;
+}
+
+// Pixel centers are aligned like GPU sampling. Weights have 7 bits, so that every product fits the 16-bit lanes of SSE2:
+// each output row blends its two source rows into a 16-bit row first, then each output pixel blends two of its pixels.
+static QImage ResampleBilinear(const QImage &image, uint32_t width, uint32_t height)
+{
+	const uint32_t srcWidth = image.width();
+	const uint32_t srcHeight = image.height();
+
+	// 16.16 fixed point
+	auto sourcePosition = [](uint32_t position, uint32_t srcSize, uint32_t size) {
+		int64_t ret = (((int64_t)position * 2 + 1) * srcSize << 16) / (size * 2) - 32768;
+		return (uint32_t)std::clamp<int64_t>(ret, 0, ((int64_t)srcSize - 1) << 16);
+	};
+
+	struct Column {
+		uint32_t left; // Offsets of the two source pixels
+		uint32_t right;
+		int16_t weights[8]; // Left and right weight of each channel, interleaved for `_mm_madd_epi16`
+	};
+	std::vector<Column> columns(width);
+	for (uint32_t x = 0; x < width; x++) {
+		uint32_t position = sourcePosition(x, srcWidth, width);
+		int16_t weight = (int16_t)((position & 0xffff) >> 9);
+		columns[x].left = (position >> 16) * 4;
+		columns[x].right = std::min((position >> 16) + 1, srcWidth - 1) * 4;
+		for (int c = 0; c < 4; c++) {
+			columns[x].weights[c * 2] = 128 - weight;
+			columns[x].weights[c * 2 + 1] = weight;
+		}
+	}
+
+	const size_t rowSize = (size_t)srcWidth * 4;
+	std::vector<int16_t> blendedRow(rowSize);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi32(1 << 13);
+
+	QImage ret(width, height, QImage::Format_RGBA8888);
+	for (uint32_t y = 0; y < height; y++) {
+		uint32_t row = sourcePosition(y, srcHeight, height);
+		const uint8_t *top = image.constScanLine(row >> 16);
+		const uint8_t *bottom = image.constScanLine(std::min((row >> 16) + 1, srcHeight - 1));
+		int16_t weightY = (int16_t)((row & 0xffff) >> 9);
+
+		const __m128i topWeight = _mm_set1_epi16(128 - weightY);
+		const __m128i bottomWeight = _mm_set1_epi16(weightY);
+		size_t i = 0;
+		for (; i + 8 <= rowSize; i += 8) {
+			__m128i topValues = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(top + i)), zero);
+			__m128i bottomValues = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(bottom + i)), zero);
+			__m128i blended =
+				_mm_add_epi16(_mm_mullo_epi16(topValues, topWeight), _mm_mullo_epi16(bottomValues, bottomWeight));
+			_mm_storeu_si128((__m128i *)(blendedRow.data() + i), blended);
+		}
+		for (; i < rowSize; i++)
+			blendedRow[i] = top[i] * (128 - weightY) + bottom[i] * weightY;
+
+		uint8_t *out = ret.scanLine(y);
+		for (uint32_t x = 0; x < width; x++) {
+			const Column &column = columns[x];
+			__m128i left = _mm_loadl_epi64((const __m128i *)(blendedRow.data() + column.left));
+			__m128i right = _mm_loadl_epi64((const __m128i *)(blendedRow.data() + column.right));
+			__m128i weights = _mm_loadu_si128((const __m128i *)column.weights);
+			__m128i sum = _mm_madd_epi16(_mm_unpacklo_epi16(left, right), weights);
+			__m128i value = _mm_srai_epi32(_mm_add_epi32(sum, rounding), 14);
+			value = _mm_packs_epi32(value, value);
+			int32_t pixel = _mm_cvtsi128_si32(_mm_packus_epi16(value, value));
+			memcpy(out + x * 4, &pixel, 4);
+		}
+	}
+
+	return ret;
+}
+
+void Utils::Image::CopyRows(uint8_t *dst, uint32_t dstLinesize, const uint8_t *src, uint32_t srcLinesize, uint32_t lineSize,
+			    uint32_t height)
+{
+	if (dstLinesize == lineSize && srcLinesize == lineSize) {
+		memcpy(dst, src, (size_t)lineSize * height);
+		return;
+	}
+
+	for (uint32_t y = 0; y < height; y++)
+		memcpy(dst + (size_t)y * dstLinesize, src + (size_t)y * srcLinesize, lineSize);
+}
+
+void Utils::Image::SwizzleRedBlue(uint8_t *dst, const uint8_t *src, size_t pixels)
+{
+	const __m128i greenAlphaMask = _mm_set1_epi32((int)0xFF00FF00);
+
+	size_t i = 0;
+	for (; i + 4 <= pixels; i += 4) {
+		__m128i pixel = _mm_loadu_si128((const __m128i *)(src + i * 4));
+		__m128i redBlue = _mm_andnot_si128(greenAlphaMask, pixel);
+		redBlue = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+		_mm_storeu_si128((__m128i *)(dst + i * 4), _mm_or_si128(_mm_and_si128(pixel, greenAlphaMask), redBlue));
+	}
+
+	for (; i < pixels; i++) {
+		uint8_t red = src[i * 4];
+		dst[i * 4] = src[i * 4 + 2];
+		dst[i * 4 + 1] = src[i * 4 + 1];
+		dst[i * 4 + 2] = red;
+		dst[i * 4 + 3] = src[i * 4 + 3];
+	}
+}
+
+void Utils::Image::PackRgb(uint8_t *dst, const uint8_t *src, size_t pixels)
+{
+	// Each 64-bit lane of two pixels is packed into its low 6 bytes, then the upper lane is moved next to the lower one
+	const __m128i lowPixelMask = _mm_set1_epi64x(0x0000000000FFFFFF);
+	const __m128i highPixelMask = _mm_set1_epi64x(0x0000FFFFFF000000);
+	const __m128i lowLaneMask = _mm_set_epi64x(0, -1);
+
+	size_t i = 0;
+	for (; i + 4 <= pixels; i += 4) {
+		__m128i pixel = _mm_loadu_si128((const __m128i *)(src + i * 4));
+		__m128i lanes =
+			_mm_or_si128(_mm_and_si128(pixel, lowPixelMask), _mm_and_si128(_mm_srli_epi64(pixel, 8), highPixelMask));
+		__m128i packed =
+			_mm_or_si128(_mm_and_si128(lanes, lowLaneMask), _mm_srli_si128(_mm_andnot_si128(lowLaneMask, lanes), 2));
+
+		// 12 bytes are stored, so that nothing past the end of `dst` is written
+		_mm_storel_epi64((__m128i *)(dst + i * 3), packed);
+		int32_t lastPixels = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+		memcpy(dst + i * 3 + 8, &lastPixels, 4);
+	}
+
+	for (; i < pixels; i++)
+		memcpy(dst + i * 3, src + i * 4, 3);
+}
+
+QImage Utils::Image::Downscale(const QImage &image, uint32_t width, uint32_t height)
+{
+	QImage ret = image.format() == QImage::Format_RGBA8888 ? image : image.convertToFormat(QImage::Format_RGBA8888);
+
+	while ((uint32_t)ret.width() >= width * 2 && (uint32_t)ret.height() >= height * 2)
+		ret = Halve(ret);
+
+	if ((uint32_t)ret.width() != width || (uint32_t)ret.height() != height)
+		ret = ResampleBilinear(ret, width, height);
+
+	return ret;
+}
+
+std::vector<std::string> Utils::Image::GetSupportedFormats()
+{
+	std::vector<std::string> ret;
+	for (const QByteArray &format : QImageWriter::supportedImageFormats())
+		ret.push_back(format.toStdString());
+
+	for (auto format : {"qoi", "rgba", "bgra"})
+		if (std::find(ret.begin(), ret.end(), format) == ret.end())
+			ret.push_back(format);
+
+	return ret;
+}
+
+bool Utils::Image::IsFormatSupported(const std::string &format)
+{
+	if (format == "qoi" || format == "rgba" || format == "bgra")
+		return true;
+
+	return QImageWriter::supportedImageFormats().contains(format.c_str());
+}
+
+bool Utils::Image::Encode(const QImage &image, const std::string &format, int quality, QByteArray &encodedImage)
+{
+	uint64_t startTime = os_gettime_ns();
+
+	QImage rgbaImage = image.format() == QImage::Format_RGBA8888 ? image : image.convertToFormat(QImage::Format_RGBA8888);
+
+	bool success = true;
+	if (format == "qoi") {
+		EncodeQoi(rgbaImage, encodedImage);
+	} else if (format == "rgba" || format == "bgra") {
+		EncodeRaw(rgbaImage, format == "bgra", encodedImage);
+	} else if (format == "jpg" || format == "jpeg") {
+		// JPEG has no alpha channel, and Qt converts every other format than RGB888 and RGB32 one row at a time
+		QImage rgbImage(rgbaImage.width(), rgbaImage.height(), QImage::Format_RGB888);
+		for (int y = 0; y < rgbImage.height(); y++)
+			PackRgb(rgbImage.scanLine(y), rgbaImage.constScanLine(y), rgbImage.width());
+
+		encodedImage.clear();
+		QBuffer buffer(&encodedImage);
+		buffer.open(QBuffer::WriteOnly);
+		success = rgbImage.save(&buffer, format.c_str(), quality);
+		buffer.close();
+	} else {
+		// For PNG, the quality selects the zlib level: 100 is the fastest with the largest output, 0 the smallest
+		encodedImage.clear();
+		QBuffer buffer(&encodedImage);
+		buffer.open(QBuffer::WriteOnly);
+		success = rgbaImage.save(&buffer, format.c_str(), quality);
+		buffer.close();
+	}
+
+	if (!success)
+		return false;
+
+	uint64_t encodeTime = os_gettime_ns() - startTime;
+
+	std::lock_guard<std::mutex> lock(encoderStatsMutex);
+	EncoderStats &stats = encoderStats[format];
+	stats.encodedImages++;
+	stats.totalEncodeTime += encodeTime;
+	stats.totalEncodedBytes += encodedImage.size();
+
+	return true;
+}
+
+bool Utils::Image::EncodeInPool(const QImage &image, const std::string &format, int quality, QByteArray &encodedImage)
+{
+	std::promise<bool> encodePromise;
+	std::future<bool> encodeFuture = encodePromise.get_future();
+
+	GetEncoderPool()->start(Utils::Compat::CreateFunctionRunnable([&]() {
+		encodePromise.set_value(Encode(image, format, quality, encodedImage));
+	}));
+
+	return encodeFuture.get();
+}
+
+QThreadPool *Utils::Image::GetEncoderPool()
+{
+	static QThreadPool encoderPool;
+	static std::once_flag initFlag;
+	std::call_once(initFlag, [] { encoderPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2)); });
+
+	return &encoderPool;
+}
+
+json Utils::Image::GetEncoderStats()
+{
+	json ret = json::object();
+
+	std::lock_guard<std::mutex> lock(encoderStatsMutex);
+	for (auto &[format, stats] : encoderStats) {
+		json formatStats;
+		formatStats["encodedImages"] = stats.encodedImages;
+		formatStats["totalEncodeTime"] = stats.totalEncodeTime / 1000000.0;
+		formatStats["averageEncodeTime"] = stats.totalEncodeTime / 1000000.0 / stats.encodedImages;
+		formatStats["totalEncodedBytes"] = stats.totalEncodedBytes;
+		ret[format] = formatStats;
+	}
+
+	return ret;
+}
@@ -0,0 +1,55 @@
+/*
+obs-websocket
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include <QImage>
+#include <QThreadPool>
+
+#include "Json.h"
+
+namespace Utils {
+	namespace Image {
+		// Copies `height` rows of `lineSize` bytes, in a single copy if neither buffer has row padding
+		void CopyRows(uint8_t *dst, uint32_t dstLinesize, const uint8_t *src, uint32_t srcLinesize, uint32_t lineSize,
+			      uint32_t height);
+		// Swaps the red and blue channels of 32-bit pixels. `dst` may be `src`
+		void SwizzleRedBlue(uint8_t *dst, const uint8_t *src, size_t pixels);
+		// Drops the alpha channel of 32-bit pixels
+		void PackRgb(uint8_t *dst, const uint8_t *src, size_t pixels);
+		// Box filters by halves while the image is at least twice the target size, then resamples the rest bilinearly
+		QImage Downscale(const QImage &image, uint32_t width, uint32_t height);
+
+		// Formats of QImageWriter, plus `qoi` and the uncompressed `rgba` and `bgra`
+		std::vector<std::string> GetSupportedFormats();
+		bool IsFormatSupported(const std::string &format);
+
+		// Encodes a `Format_RGBA8888` image on the calling thread. `quality` is ignored by `qoi`, `rgba` and `bgra`
+		bool Encode(const QImage &image, const std::string &format, int quality, QByteArray &encodedImage);
+		// Encodes on the encoder pool and waits for the result, so that encodes do not starve request processing threads
+		bool EncodeInPool(const QImage &image, const std::string &format, int quality, QByteArray &encodedImage);
+		// Bounded to half of the available cores. Tasks running on it must use `Encode()`
+		QThreadPool *GetEncoderPool();
+
+		// Per format: `encodedImages`, `totalEncodeTime` and `averageEncodeTime` (milliseconds), and `totalEncodedBytes`
+		json GetEncoderStats();
+	}
+}
@@ -17,7 +17,12 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <random>
 
 #include "Json.h"
 #include "plugin-macros.generated.h"
@@ -32,9 +37,9 @@ bool Utils::Json::JsonArrayIsValidObsArray(const json &j)
 	return true;
 }
 
-void obs_data_set_json_object_item(obs_data_t *d, json j);
+static void obs_data_set_json_object_item(obs_data_t *d, const json &j);
 
-void obs_data_set_json_object(obs_data_t *d, const char *key, json j)
+static void obs_data_set_json_object(obs_data_t *d, const char *key, const json &j)
 {
 	obs_data_t *subObj = obs_data_create();
 	obs_data_set_json_object_item(subObj, j);
@@ -42,11 +47,11 @@ void obs_data_set_json_object(obs_data_t *d, const char *key, json j)
 	obs_data_release(subObj);
 }
 
-void obs_data_set_json_array(obs_data_t *d, const char *key, json j)
+static void obs_data_set_json_array(obs_data_t *d, const char *key, const json &j)
 {
 	obs_data_array_t *array = obs_data_array_create();
 
-	for (auto &[key, value] : j.items()) {
+	for (const json &value : j) {
 		if (!value.is_object())
 			continue;
 
@@ -60,93 +65,96 @@ void obs_data_set_json_array(obs_data_t *d, const char *key, json j)
 	obs_data_array_release(array);
 }
 
-void obs_data_set_json_object_item(obs_data_t *d, json j)
+// Subtrees and strings are passed by reference all the way down, so nothing of `j` is copied
+static void obs_data_set_json_object_item(obs_data_t *d, const json &j)
 {
-	for (auto &[key, value] : j.items()) {
+	for (auto it = j.begin(); it != j.end(); ++it) {
+		const char *key = it.key().c_str();
+		const json &value = it.value();
 		if (value.is_object()) {
-			obs_data_set_json_object(d, key.c_str(), value);
+			obs_data_set_json_object(d, key, value);
 		} else if (value.is_array()) {
-			obs_data_set_json_array(d, key.c_str(), value);
+			obs_data_set_json_array(d, key, value);
 		} else if (value.is_string()) {
-			obs_data_set_string(d, key.c_str(), value.get<std::string>().c_str());
+			obs_data_set_string(d, key, value.get_ref<const std::string &>().c_str());
 		} else if (value.is_number_integer()) {
-			obs_data_set_int(d, key.c_str(), value.get<int64_t>());
+			obs_data_set_int(d, key, value.get<int64_t>());
 		} else if (value.is_number_float()) {
-			obs_data_set_double(d, key.c_str(), value.get<double>());
+			obs_data_set_double(d, key, value.get<double>());
 		} else if (value.is_boolean()) {
-			obs_data_set_bool(d, key.c_str(), value.get<bool>());
+			obs_data_set_bool(d, key, value.get<bool>());
 		} else if (value.is_null()) {
-			obs_data_set_obj(d, key.c_str(), NULL);
+			obs_data_set_obj(d, key, NULL);
 		}
 	}
 }
 
-obs_data_t *Utils::Json::JsonToObsData(json j)
+obs_data_t *Utils::Json::JsonToObsData(const json &j)
 {
-	obs_data_t *data = obs_data_create();
-
-	if (!j.is_object()) {
-		obs_data_release(data);
+	if (!j.is_object())
 		return nullptr;
-	}
 
+	obs_data_t *data = obs_data_create();
 	obs_data_set_json_object_item(data, j);
 
 	return data;
 }
 
-void set_json_string(json *j, const char *name, obs_data_item_t *item)
+static void obs_data_to_json_object(json &j, obs_data_t *d, bool includeDefault);
+
+static void set_json_string(json &j, const char *name, obs_data_item_t *item)
 {
 	const char *val = obs_data_item_get_string(item);
-	j->emplace(name, val);
+	j.emplace(name, val);
 }
-void set_json_number(json *j, const char *name, obs_data_item_t *item)
+static void set_json_number(json &j, const char *name, obs_data_item_t *item)
 {
 	enum obs_data_number_type type = obs_data_item_numtype(item);
 
 	if (type == OBS_DATA_NUM_INT) {
 		long long val = obs_data_item_get_int(item);
-		j->emplace(name, val);
+		j.emplace(name, val);
 	} else {
 		double val = obs_data_item_get_double(item);
-		j->emplace(name, val);
+		j.emplace(name, val);
 	}
 }
-void set_json_bool(json *j, const char *name, obs_data_item_t *item)
+static void set_json_bool(json &j, const char *name, obs_data_item_t *item)
 {
 	bool val = obs_data_item_get_bool(item);
-	j->emplace(name, val);
+	j.emplace(name, val);
 }
-void set_json_object(json *j, const char *name, obs_data_item_t *item, bool includeDefault)
+static void set_json_object(json &j, const char *name, obs_data_item_t *item, bool includeDefault)
 {
 	obs_data_t *obj = obs_data_item_get_obj(item);
-	j->emplace(name, Utils::Json::ObsDataToJson(obj, includeDefault));
+	json &jObject = j.emplace(name, json::object()).first.value();
+	obs_data_to_json_object(jObject, obj, includeDefault);
 	obs_data_release(obj);
 }
-void set_json_array(json *j, const char *name, obs_data_item_t *item, bool includeDefault)
+static void set_json_array(json &j, const char *name, obs_data_item_t *item, bool includeDefault)
 {
-	json jArray = json::array();
 	obs_data_array_t *array = obs_data_item_get_array(item);
 	size_t count = obs_data_array_count(array);
 
+	json &jArray = j.emplace(name, json::array()).first.value();
+	jArray.get_ref<json::array_t &>().reserve(count);
+
 	for (size_t idx = 0; idx < count; idx++) {
 		obs_data_t *subItem = obs_data_array_item(array, idx);
-		json jItem = Utils::Json::ObsDataToJson(subItem, includeDefault);
+		obs_data_to_json_object(jArray.emplace_back(json::object()), subItem, includeDefault);
 		obs_data_release(subItem);
-		jArray.push_back(jItem);
 	}
 
 	obs_data_array_release(array);
-	j->emplace(name, jArray);
 }
 
-json Utils::Json::ObsDataToJson(obs_data_t *d, bool includeDefault)
+// Children are built in place inside their parent, instead of being built separately and copied in
+static void obs_data_to_json_object(json &j, obs_data_t *d, bool includeDefault)
 {
-	json j = json::object();
 	obs_data_item_t *item = nullptr;
 
 	if (!d)
-		return j;
+		return;
 
 	for (item = obs_data_first(d); item; obs_data_item_next(&item)) {
 		enum obs_data_type type = obs_data_item_gettype(item);
@@ -157,27 +165,413 @@ json Utils::Json::ObsDataToJson(obs_data_t *d, bool includeDefault)
 
 		switch (type) {
 		case OBS_DATA_STRING:
-			set_json_string(&j, name, item);
+			set_json_string(j, name, item);
 			break;
 		case OBS_DATA_NUMBER:
-			set_json_number(&j, name, item);
+			set_json_number(j, name, item);
 			break;
 		case OBS_DATA_BOOLEAN:
-			set_json_bool(&j, name, item);
+			set_json_bool(j, name, item);
 			break;
 		case OBS_DATA_OBJECT:
-			set_json_object(&j, name, item, includeDefault);
+			set_json_object(j, name, item, includeDefault);
 			break;
 		case OBS_DATA_ARRAY:
-			set_json_array(&j, name, item, includeDefault);
+			set_json_array(j, name, item, includeDefault);
 			break;
 		default:;
 		}
 	}
+}
 
+json Utils::Json::ObsDataToJson(obs_data_t *d, bool includeDefault)
+{
+	json j = json::object();
+	obs_data_to_json_object(j, d, includeDefault);
 	return j;
 }
 
+static bool obs_data_item_is_serialized(obs_data_item_t *item, bool includeDefault)
+{
+	enum obs_data_type type = obs_data_item_gettype(item);
+	if (type != OBS_DATA_STRING && type != OBS_DATA_NUMBER && type != OBS_DATA_BOOLEAN && type != OBS_DATA_OBJECT &&
+	    type != OBS_DATA_ARRAY)
+		return false;
+
+	return includeDefault || obs_data_item_has_user_value(item);
+}
+
+static void append_json_string(std::string &out, const char *str)
+{
+	out += '"';
+
+	// Runs of characters which need no escaping are appended at once
+	const char *run = str;
+	for (const char *c = str; *c; c++) {
+		unsigned char ch = *c;
+		if (ch >= 0x20 && ch != '"' && ch != '\\')
+			continue;
+
+		out.append(run, c - run);
+		run = c + 1;
+
+		switch (ch) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default: {
+			static const char hexDigits[] = "0123456789abcdef";
+			char escaped[6] = {'\\', 'u', '0', '0', hexDigits[ch >> 4], hexDigits[ch & 0xf]};
+			out.append(escaped, 6);
+		}
+		}
+	}
+	out.append(run, strlen(run));
+
+	out += '"';
+}
+
+static void append_json_number(std::string &out, obs_data_item_t *item)
+{
+	if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT) {
+		char buffer[24];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), obs_data_item_get_int(item));
+		out.append(buffer, result.ptr - buffer);
+	} else {
+		// Formatted by the json library, which is locale independent and keeps a fraction on whole numbers
+		out += json(obs_data_item_get_double(item)).dump();
+	}
+}
+
+static void append_obs_data_json(std::string &out, obs_data_t *d, bool includeDefault);
+
+static void append_obs_data_array_json(std::string &out, obs_data_array_t *array, bool includeDefault)
+{
+	out += '[';
+
+	size_t count = obs_data_array_count(array);
+	for (size_t idx = 0; idx < count; idx++) {
+		if (idx)
+			out += ',';
+
+		obs_data_t *subItem = obs_data_array_item(array, idx);
+		append_obs_data_json(out, subItem, includeDefault);
+		obs_data_release(subItem);
+	}
+
+	out += ']';
+}
+
+static void append_obs_data_json(std::string &out, obs_data_t *d, bool includeDefault)
+{
+	out += '{';
+
+	bool first = true;
+	obs_data_item_t *item = nullptr;
+	for (item = d ? obs_data_first(d) : nullptr; item; obs_data_item_next(&item)) {
+		if (!obs_data_item_is_serialized(item, includeDefault))
+			continue;
+
+		if (!first)
+			out += ',';
+		first = false;
+
+		append_json_string(out, obs_data_item_get_name(item));
+		out += ':';
+
+		switch (obs_data_item_gettype(item)) {
+		case OBS_DATA_STRING: {
+			const char *str = obs_data_item_get_string(item);
+			append_json_string(out, str ? str : "");
+			break;
+		}
+		case OBS_DATA_NUMBER:
+			append_json_number(out, item);
+			break;
+		case OBS_DATA_BOOLEAN:
+			out += obs_data_item_get_bool(item) ? "true" : "false";
+			break;
+		case OBS_DATA_OBJECT: {
+			obs_data_t *obj = obs_data_item_get_obj(item);
+			append_obs_data_json(out, obj, includeDefault);
+			obs_data_release(obj);
+			break;
+		}
+		case OBS_DATA_ARRAY: {
+			obs_data_array_t *array = obs_data_item_get_array(item);
+			append_obs_data_array_json(out, array, includeDefault);
+			obs_data_array_release(array);
+			break;
+		}
+		default:;
+		}
+	}
+
+	out += '}';
+}
+
+std::string Utils::Json::ObsDataToJsonString(obs_data_t *d, bool includeDefault)
+{
+	std::string ret;
+	append_obs_data_json(ret, d, includeDefault);
+	return ret;
+}
+
+static void append_msgpack_big_endian(std::vector<uint8_t> &out, uint64_t value, size_t bytes)
+{
+	for (size_t i = bytes; i > 0; i--)
+		out.push_back((uint8_t)(value >> ((i - 1) * 8)));
+}
+
+// Strings, arrays and maps have a short form which holds the size itself, and 16 and 32 bit forms which follow each other
+static void append_msgpack_header(std::vector<uint8_t> &out, size_t size, uint8_t fixType, size_t fixMax, uint8_t type16)
+{
+	if (size <= fixMax) {
+		out.push_back(fixType | (uint8_t)size);
+	} else if (size <= UINT16_MAX) {
+		out.push_back(type16);
+		append_msgpack_big_endian(out, size, 2);
+	} else {
+		out.push_back(type16 + 1);
+		append_msgpack_big_endian(out, size, 4);
+	}
+}
+
+static void append_msgpack_string(std::vector<uint8_t> &out, const char *str)
+{
+	size_t size = strlen(str);
+	if (size > 31 && size <= UINT8_MAX) {
+		out.push_back(0xd9);
+		out.push_back((uint8_t)size);
+	} else {
+		append_msgpack_header(out, size, 0xa0, 31, 0xda);
+	}
+	out.insert(out.end(), str, str + size);
+}
+
+// Uses the smallest encoding which holds the value, like the json library does
+static void append_msgpack_int(std::vector<uint8_t> &out, int64_t value)
+{
+	if (value >= 0) {
+		if (value <= 0x7f) {
+			out.push_back((uint8_t)value);
+		} else if (value <= UINT8_MAX) {
+			out.push_back(0xcc);
+			append_msgpack_big_endian(out, value, 1);
+		} else if (value <= UINT16_MAX) {
+			out.push_back(0xcd);
+			append_msgpack_big_endian(out, value, 2);
+		} else if (value <= UINT32_MAX) {
+			out.push_back(0xce);
+			append_msgpack_big_endian(out, value, 4);
+		} else {
+			out.push_back(0xcf);
+			append_msgpack_big_endian(out, value, 8);
+		}
+	} else {
+		if (value >= -32) {
+			out.push_back((uint8_t)value);
+		} else if (value >= INT8_MIN) {
+			out.push_back(0xd0);
+			append_msgpack_big_endian(out, (uint64_t)value, 1);
+		} else if (value >= INT16_MIN) {
+			out.push_back(0xd1);
+			append_msgpack_big_endian(out, (uint64_t)value, 2);
+		} else if (value >= INT32_MIN) {
+			out.push_back(0xd2);
+			append_msgpack_big_endian(out, (uint64_t)value, 4);
+		} else {
+			out.push_back(0xd3);
+			append_msgpack_big_endian(out, (uint64_t)value, 8);
+		}
+	}
+}
+
+static void append_msgpack_double(std::vector<uint8_t> &out, double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	out.push_back(0xcb);
+	append_msgpack_big_endian(out, bits, 8);
+}
+
+static void append_obs_data_msgpack(std::vector<uint8_t> &out, obs_data_t *d, bool includeDefault)
+{
+	// Maps start with their size, so the items are counted first
+	size_t count = 0;
+	obs_data_item_t *item = nullptr;
+	for (item = d ? obs_data_first(d) : nullptr; item; obs_data_item_next(&item))
+		if (obs_data_item_is_serialized(item, includeDefault))
+			count++;
+
+	append_msgpack_header(out, count, 0x80, 15, 0xde);
+
+	for (item = d ? obs_data_first(d) : nullptr; item; obs_data_item_next(&item)) {
+		if (!obs_data_item_is_serialized(item, includeDefault))
+			continue;
+
+		append_msgpack_string(out, obs_data_item_get_name(item));
+
+		switch (obs_data_item_gettype(item)) {
+		case OBS_DATA_STRING: {
+			const char *str = obs_data_item_get_string(item);
+			append_msgpack_string(out, str ? str : "");
+			break;
+		}
+		case OBS_DATA_NUMBER:
+			if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT)
+				append_msgpack_int(out, obs_data_item_get_int(item));
+			else
+				append_msgpack_double(out, obs_data_item_get_double(item));
+			break;
+		case OBS_DATA_BOOLEAN:
+			out.push_back(obs_data_item_get_bool(item) ? 0xc3 : 0xc2);
+			break;
+		case OBS_DATA_OBJECT: {
+			obs_data_t *obj = obs_data_item_get_obj(item);
+			append_obs_data_msgpack(out, obj, includeDefault);
+			obs_data_release(obj);
+			break;
+		}
+		case OBS_DATA_ARRAY: {
+			obs_data_array_t *array = obs_data_item_get_array(item);
+			size_t arrayCount = obs_data_array_count(array);
+			append_msgpack_header(out, arrayCount, 0x90, 15, 0xdc);
+			for (size_t idx = 0; idx < arrayCount; idx++) {
+				obs_data_t *subItem = obs_data_array_item(array, idx);
+				append_obs_data_msgpack(out, subItem, includeDefault);
+				obs_data_release(subItem);
+			}
+			obs_data_array_release(array);
+			break;
+		}
+		default:;
+		}
+	}
+}
+
+std::vector<uint8_t> Utils::Json::ObsDataToMsgPack(obs_data_t *d, bool includeDefault)
+{
+	std::vector<uint8_t> ret;
+	append_obs_data_msgpack(ret, d, includeDefault);
+	return ret;
+}
+
+json Utils::Json::RawFields::Add(obs_data_t *d, bool includeDefault)
+{
+	static const std::string placeholderPrefix = [] {
+		std::random_device rd;
+		std::uniform_int_distribution<uint64_t> dist;
+		return "\x01obs-websocket raw field " + std::to_string(dist(rd)) + ":";
+	}();
+
+	Field field;
+	field.placeholder = placeholderPrefix + std::to_string(_fields.size());
+	if (_encodings & EncodeJson)
+		field.jsonText = ObsDataToJsonString(d, includeDefault);
+	if (_encodings & EncodeMsgPack)
+		field.msgPack = ObsDataToMsgPack(d, includeDefault);
+
+	_fields.push_back(std::move(field));
+	return _fields.back().placeholder;
+}
+
+// A field which was only serialized in the other encoding is converted
+const std::string &Utils::Json::RawFields::GetJsonText(const Field &field, std::string &converted) const
+{
+	if (_encodings & EncodeJson)
+		return field.jsonText;
+
+	converted = json::from_msgpack(field.msgPack).dump();
+	return converted;
+}
+
+const std::vector<uint8_t> &Utils::Json::RawFields::GetMsgPack(const Field &field, std::vector<uint8_t> &converted) const
+{
+	if (_encodings & EncodeMsgPack)
+		return field.msgPack;
+
+	converted = json::to_msgpack(json::parse(field.jsonText));
+	return converted;
+}
+
+std::string Utils::Json::RawFields::Dump(const json &message) const
+{
+	std::string ret = message.dump();
+
+	for (auto &field : _fields) {
+		std::string placeholder = json(field.placeholder).dump();
+		size_t pos = ret.find(placeholder);
+		if (pos == std::string::npos)
+			continue;
+
+		std::string converted;
+		ret.replace(pos, placeholder.size(), GetJsonText(field, converted));
+	}
+
+	return ret;
+}
+
+std::vector<uint8_t> Utils::Json::RawFields::ToMsgPack(const json &message) const
+{
+	std::vector<uint8_t> ret = json::to_msgpack(message);
+
+	for (auto &field : _fields) {
+		std::vector<uint8_t> placeholder = json::to_msgpack(field.placeholder);
+		auto pos = std::search(ret.begin(), ret.end(), placeholder.begin(), placeholder.end());
+		if (pos == ret.end())
+			continue;
+
+		std::vector<uint8_t> converted;
+		const std::vector<uint8_t> &msgPack = GetMsgPack(field, converted);
+		pos = ret.erase(pos, pos + placeholder.size());
+		ret.insert(pos, msgPack.begin(), msgPack.end());
+	}
+
+	return ret;
+}
+
+json Utils::Json::RawFields::Expand(json message) const
+{
+	if (_fields.empty())
+		return message;
+
+	std::function<void(json &)> expand = [&](json &value) {
+		if (value.is_structured()) {
+			for (auto &child : value)
+				expand(child);
+			return;
+		}
+
+		if (!value.is_string())
+			return;
+
+		for (auto &field : _fields) {
+			if (value.get_ref<const std::string &>() != field.placeholder)
+				continue;
+
+			std::string converted;
+			value = json::parse(GetJsonText(field, converted));
+			return;
+		}
+	};
+	expand(message);
+
+	return message;
+}
+
 bool Utils::Json::GetJsonFileContent(std::string fileName, json &content)
 {
 	std::ifstream f(std::filesystem::u8path(fileName));
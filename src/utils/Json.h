@@ -20,6 +20,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <string>
+#include <vector>
 #include <obs.hpp>
 #include <nlohmann/json.hpp>
 
@@ -91,13 +92,54 @@ NLOHMANN_JSON_SERIALIZE_ENUM(obs_deinterlace_field_order,
 namespace Utils {
 	namespace Json {
 		bool JsonArrayIsValidObsArray(const json &j);
-		obs_data_t *JsonToObsData(json j);
+		obs_data_t *JsonToObsData(const json &j);
 		json ObsDataToJson(obs_data_t *d, bool includeDefault = false);
+		// Same as `ObsDataToJson(d).dump()` and `json::to_msgpack(ObsDataToJson(d))`, without building the json object.
+		// Keys are in the order of `d`
+		std::string ObsDataToJsonString(obs_data_t *d, bool includeDefault = false);
+		std::vector<uint8_t> ObsDataToMsgPack(obs_data_t *d, bool includeDefault = false);
 		bool GetJsonFileContent(std::string fileName, json &content);
 		bool SetJsonFileContent(std::string fileName, const json &content, bool makeDirs = true);
 		static inline bool Contains(const json &j, std::string key)
 		{
 			return j.contains(key) && !j[key].is_null();
 		}
+
+		// obs_data fields of a message which are serialized straight into the encoded message, instead of being built
+		// as json objects first. Until then the message holds a placeholder string in place of each field, which
+		// contains a random value so that it can not be sent by a client.
+		// The obs_data is serialized when it is added, as it may be modified by other threads once the caller returns.
+		class RawFields {
+		public:
+			enum Encoding : uint8_t {
+				EncodeJson = (1 << 0),
+				EncodeMsgPack = (1 << 1),
+			};
+
+			RawFields(uint8_t encodings = EncodeJson | EncodeMsgPack) : _encodings(encodings) {}
+
+			// Returns the placeholder to put in the message in place of the field
+			json Add(obs_data_t *d, bool includeDefault = false);
+			inline bool Empty() const { return _fields.empty(); }
+
+			// Encode `message` with the fields written in place of their placeholders
+			std::string Dump(const json &message) const;
+			std::vector<uint8_t> ToMsgPack(const json &message) const;
+			// For consumers of the json object itself, like debug logging
+			json Expand(json message) const;
+
+		private:
+			struct Field {
+				std::string placeholder;
+				std::string jsonText;
+				std::vector<uint8_t> msgPack;
+			};
+
+			const std::string &GetJsonText(const Field &field, std::string &converted) const;
+			const std::vector<uint8_t> &GetMsgPack(const Field &field, std::vector<uint8_t> &converted) const;
+
+			uint8_t _encodings;
+			std::vector<Field> _fields;
+		};
 	}
 }
@@ -17,5 +17,22 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
+
 #include "Obs.h"
 #include "plugin-macros.generated.h"
+
+std::string Utils::Obs::FieldSelector::ToString() const
+{
+	std::vector<std::string> sortedFields(Fields.begin(), Fields.end());
+	std::sort(sortedFields.begin(), sortedFields.end());
+
+	std::string ret;
+	for (auto &field : sortedFields) {
+		if (!ret.empty())
+			ret += ",";
+		ret += field;
+	}
+
+	return ret;
+}
@@ -20,6 +20,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <string>
+#include <unordered_set>
 #include <obs.hpp>
 #include <obs-frontend-api.h>
 
@@ -225,6 +226,15 @@ NLOHMANN_JSON_SERIALIZE_ENUM(ObsMediaInputAction,
 
 namespace Utils {
 	namespace Obs {
+		// Selects which fields of the objects built by the helpers are fetched. An empty selector selects all fields
+		struct FieldSelector {
+			std::unordered_set<std::string> Fields;
+
+			inline bool Has(const std::string &field) const { return Fields.empty() || Fields.count(field); }
+			// Sorted and comma separated, for use in cache keys
+			std::string ToString() const;
+		};
+
 		namespace StringHelper {
 			std::string GetObsVersion();
 			std::string GetModuleConfigPath(std::string fileName);
@@ -253,13 +263,13 @@ namespace Utils {
 			std::vector<json> GetSceneList();
 			std::vector<json> GetCanvasSceneList(obs_canvas_t *canvas);
 			std::vector<std::string> GetCanvasGroupList(obs_canvas_t *canvas);
-			std::vector<json> GetSceneItemList(obs_scene_t *scene, bool basic = false);
-			std::vector<json> GetInputList(std::string inputKind = "");
+			std::vector<json> GetSceneItemList(obs_scene_t *scene, const FieldSelector &fields = {});
+			std::vector<json> GetInputList(std::string inputKind = "", const FieldSelector &fields = {});
 			std::vector<std::string> GetInputKindList(bool unversioned = false, bool includeDisabled = false);
 			std::vector<json> GetListPropertyItems(obs_property_t *property);
 			std::vector<std::string> GetTransitionKindList();
 			std::vector<json> GetSceneTransitionList();
-			std::vector<json> GetSourceFilterList(obs_source_t *source);
+			std::vector<json> GetSourceFilterList(obs_source_t *source, const FieldSelector &fields = {});
 			std::vector<std::string> GetFilterKindList();
 			std::vector<json> GetOutputList();
 		}
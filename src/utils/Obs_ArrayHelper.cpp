@@ -152,58 +152,105 @@ std::vector<std::string> Utils::Obs::ArrayHelper::GetCanvasGroupList(obs_canvas_
 	return ret;
 }
 
-std::vector<json> Utils::Obs::ArrayHelper::GetSceneItemList(obs_scene_t *scene, bool basic)
+// Selected fields are looked up once per list instead of once per item
+struct EnumSceneItemInfo {
+	std::vector<json> sceneItems;
+	bool sceneItemId;
+	bool sceneItemIndex;
+	bool sceneItemEnabled;
+	bool sceneItemLocked;
+	bool sceneItemTransform;
+	bool sceneItemBlendMode;
+	bool sourceName;
+	bool sourceUuid;
+	bool sourceType;
+	bool inputKind;
+	bool isGroup;
+};
+
+std::vector<json> Utils::Obs::ArrayHelper::GetSceneItemList(obs_scene_t *scene, const FieldSelector &fields)
 {
-	std::pair<std::vector<json>, bool> enumData;
-	enumData.second = basic;
+	EnumSceneItemInfo enumData;
+	enumData.sceneItemId = fields.Has("sceneItemId");
+	enumData.sceneItemIndex = fields.Has("sceneItemIndex");
+	enumData.sceneItemEnabled = fields.Has("sceneItemEnabled");
+	enumData.sceneItemLocked = fields.Has("sceneItemLocked");
+	enumData.sceneItemTransform = fields.Has("sceneItemTransform");
+	enumData.sceneItemBlendMode = fields.Has("sceneItemBlendMode");
+	enumData.sourceName = fields.Has("sourceName");
+	enumData.sourceUuid = fields.Has("sourceUuid");
+	enumData.sourceType = fields.Has("sourceType");
+	enumData.inputKind = fields.Has("inputKind");
+	enumData.isGroup = fields.Has("isGroup");
 
 	auto cb = [](obs_scene_t *, obs_sceneitem_t *sceneItem, void *param) {
-		auto enumData = static_cast<std::pair<std::vector<json>, bool> *>(param);
+		auto enumData = static_cast<EnumSceneItemInfo *>(param);
 
 		// TODO: Make ObjectHelper util for scene items
 
-		json item;
-		item["sceneItemId"] = obs_sceneitem_get_id(sceneItem);
-		item["sceneItemIndex"] =
-			enumData->first.size(); // Should be slightly faster than calling obs_sceneitem_get_order_position()
-		if (!enumData->second) {
+		json item = json::object();
+		if (enumData->sceneItemId)
+			item["sceneItemId"] = obs_sceneitem_get_id(sceneItem);
+		if (enumData->sceneItemIndex)
+			item["sceneItemIndex"] =
+				enumData->sceneItems.size(); // Should be slightly faster than calling obs_sceneitem_get_order_position()
+		if (enumData->sceneItemEnabled)
 			item["sceneItemEnabled"] = obs_sceneitem_visible(sceneItem);
+		if (enumData->sceneItemLocked)
 			item["sceneItemLocked"] = obs_sceneitem_locked(sceneItem);
+		if (enumData->sceneItemTransform)
 			item["sceneItemTransform"] = ObjectHelper::GetSceneItemTransform(sceneItem);
+		if (enumData->sceneItemBlendMode)
 			item["sceneItemBlendMode"] = obs_sceneitem_get_blending_mode(sceneItem);
-			OBSSource itemSource = obs_sceneitem_get_source(sceneItem);
+		OBSSource itemSource = obs_sceneitem_get_source(sceneItem);
+		if (enumData->sourceName)
 			item["sourceName"] = obs_source_get_name(itemSource);
+		if (enumData->sourceUuid)
 			item["sourceUuid"] = obs_source_get_uuid(itemSource);
+		if (enumData->sourceType)
 			item["sourceType"] = obs_source_get_type(itemSource);
+		if (enumData->inputKind) {
 			if (obs_source_get_type(itemSource) == OBS_SOURCE_TYPE_INPUT)
 				item["inputKind"] = obs_source_get_id(itemSource);
 			else
 				item["inputKind"] = nullptr;
+		}
+		if (enumData->isGroup) {
 			if (obs_source_get_type(itemSource) == OBS_SOURCE_TYPE_SCENE)
 				item["isGroup"] = obs_source_is_group(itemSource);
 			else
 				item["isGroup"] = nullptr;
 		}
 
-		enumData->first.push_back(item);
+		enumData->sceneItems.push_back(std::move(item));
 
 		return true;
 	};
 
 	obs_scene_enum_items(scene, cb, &enumData);
 
-	return enumData.first;
+	return enumData.sceneItems;
 }
 
 struct EnumInputInfo {
 	std::string inputKind; // For searching by input kind
 	std::vector<json> inputs;
+	bool inputName;
+	bool inputUuid;
+	bool inputKindField;
+	bool unversionedInputKind;
+	bool inputKindCaps;
 };
 
-std::vector<json> Utils::Obs::ArrayHelper::GetInputList(std::string inputKind)
+std::vector<json> Utils::Obs::ArrayHelper::GetInputList(std::string inputKind, const FieldSelector &fields)
 {
 	EnumInputInfo inputInfo;
 	inputInfo.inputKind = inputKind;
+	inputInfo.inputName = fields.Has("inputName");
+	inputInfo.inputUuid = fields.Has("inputUuid");
+	inputInfo.inputKindField = fields.Has("inputKind");
+	inputInfo.unversionedInputKind = fields.Has("unversionedInputKind");
+	inputInfo.inputKindCaps = fields.Has("inputKindCaps");
 
 	auto cb = [](void *param, obs_source_t *input) {
 		// Sanity check in case the API changes
@@ -217,14 +264,19 @@ std::vector<json> Utils::Obs::ArrayHelper::GetInputList(std::string inputKind)
 		if (!inputInfo->inputKind.empty() && inputInfo->inputKind != inputKind)
 			return true;
 
-		json inputJson;
-		inputJson["inputName"] = obs_source_get_name(input);
-		inputJson["inputUuid"] = obs_source_get_uuid(input);
-		inputJson["inputKind"] = inputKind;
-		inputJson["unversionedInputKind"] = obs_source_get_unversioned_id(input);
-		inputJson["inputKindCaps"] = obs_source_get_output_flags(input);
-
-		inputInfo->inputs.push_back(inputJson);
+		json inputJson = json::object();
+		if (inputInfo->inputName)
+			inputJson["inputName"] = obs_source_get_name(input);
+		if (inputInfo->inputUuid)
+			inputJson["inputUuid"] = obs_source_get_uuid(input);
+		if (inputInfo->inputKindField)
+			inputJson["inputKind"] = inputKind;
+		if (inputInfo->unversionedInputKind)
+			inputJson["unversionedInputKind"] = obs_source_get_unversioned_id(input);
+		if (inputInfo->inputKindCaps)
+			inputJson["inputKindCaps"] = obs_source_get_output_flags(input);
+
+		inputInfo->inputs.push_back(std::move(inputJson));
 		return true;
 	};
 
@@ -331,28 +383,48 @@ std::vector<std::string> Utils::Obs::ArrayHelper::GetFilterKindList()
 	return ret;
 }
 
-std::vector<json> Utils::Obs::ArrayHelper::GetSourceFilterList(obs_source_t *source)
-{
+struct EnumFilterInfo {
 	std::vector<json> filters;
+	bool filterEnabled;
+	bool filterIndex;
+	bool filterKind;
+	bool filterName;
+	bool filterSettings;
+};
 
-	auto cb = [](obs_source_t *, obs_source_t *filter, void *param) {
-		auto filters = reinterpret_cast<std::vector<json> *>(param);
-
-		json filterJson;
-		filterJson["filterEnabled"] = obs_source_enabled(filter);
-		filterJson["filterIndex"] = filters->size();
-		filterJson["filterKind"] = obs_source_get_id(filter);
-		filterJson["filterName"] = obs_source_get_name(filter);
+std::vector<json> Utils::Obs::ArrayHelper::GetSourceFilterList(obs_source_t *source, const FieldSelector &fields)
+{
+	EnumFilterInfo filterInfo;
+	filterInfo.filterEnabled = fields.Has("filterEnabled");
+	filterInfo.filterIndex = fields.Has("filterIndex");
+	filterInfo.filterKind = fields.Has("filterKind");
+	filterInfo.filterName = fields.Has("filterName");
+	filterInfo.filterSettings = fields.Has("filterSettings");
 
-		OBSDataAutoRelease filterSettings = obs_source_get_settings(filter);
-		filterJson["filterSettings"] = Utils::Json::ObsDataToJson(filterSettings);
+	auto cb = [](obs_source_t *, obs_source_t *filter, void *param) {
+		auto filterInfo = static_cast<EnumFilterInfo *>(param);
+
+		json filterJson = json::object();
+		if (filterInfo->filterEnabled)
+			filterJson["filterEnabled"] = obs_source_enabled(filter);
+		if (filterInfo->filterIndex)
+			filterJson["filterIndex"] = filterInfo->filters.size();
+		if (filterInfo->filterKind)
+			filterJson["filterKind"] = obs_source_get_id(filter);
+		if (filterInfo->filterName)
+			filterJson["filterName"] = obs_source_get_name(filter);
+
+		if (filterInfo->filterSettings) {
+			OBSDataAutoRelease filterSettings = obs_source_get_settings(filter);
+			filterJson["filterSettings"] = Utils::Json::ObsDataToJson(filterSettings);
+		}
 
-		filters->push_back(filterJson);
+		filterInfo->filters.push_back(std::move(filterJson));
 	};
 
-	obs_source_enum_filters(source, cb, &filters);
+	obs_source_enum_filters(source, cb, &filterInfo);
 
-	return filters;
+	return filterInfo.filters;
 }
 
 std::vector<json> Utils::Obs::ArrayHelper::GetOutputList()
@@ -442,23 +442,51 @@ void WebSocketServer::onMessage(websocketpp::connection_hdl hdl,
 			return;
 		}
 
-		if (!ret.result.is_null()) {
+		if (ret.result.is_null())
+			return;
+
+		auto sendResult = [&](const json &result) {
 			websocketpp::lib::error_code errorCode;
 			if (sessionEncoding == WebSocketEncoding::Json) {
-				std::string helloMessageJson = ret.result.dump();
+				std::string helloMessageJson = ret.rawFields.Dump(result);
 				_server.send(hdl, helloMessageJson, websocketpp::frame::opcode::text, errorCode);
 			} else if (sessionEncoding == WebSocketEncoding::MsgPack) {
-				auto msgPackData = json::to_msgpack(ret.result);
+				auto msgPackData = ret.rawFields.ToMsgPack(result);
 				std::string messageMsgPack(msgPackData.begin(), msgPackData.end());
 				_server.send(hdl, messageMsgPack, websocketpp::frame::opcode::binary, errorCode);
 			}
 			session->IncrementOutgoingMessages();
 
-			blog_debug("[WebSocketServer::onMessage] Outgoing message:\n%s", ret.result.dump(2).c_str());
+			blog_debug("[WebSocketServer::onMessage] Outgoing message:\n%s",
+				   ret.rawFields.Expand(result).dump(2).c_str());
 
 			if (errorCode)
 				blog(LOG_WARNING, "[WebSocketServer::onMessage] Sending message to client failed: %s",
 				     errorCode.message().c_str());
+			return !errorCode;
+		};
+
+		// Binary messages are matched to responses by their order, so responses which have some are sent one at a time
+		std::unique_lock<std::mutex> sendLock(session->BinaryResultsMutex, std::defer_lock);
+		if (!ret.binaryResults.empty())
+			sendLock.lock();
+
+		if (!sendResult(ret.result))
+			return;
+
+		// Each additional result is only encoded once the previous one has been sent
+		for (auto &result : ret.additionalResults)
+			if (!sendResult(result))
+				return;
+
+		for (auto &binaryResult : ret.binaryResults) {
+			_server.send(hdl, binaryResult.data(), binaryResult.size(), websocketpp::frame::opcode::binary, errorCode);
+			if (errorCode) {
+				blog(LOG_WARNING, "[WebSocketServer::onMessage] Sending binary message to client failed: %s",
+				     errorCode.message().c_str());
+				return;
+			}
+			session->IncrementOutgoingMessages();
 		}
 	}));
 }
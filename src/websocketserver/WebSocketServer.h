@@ -56,7 +56,9 @@ public:
 	void Stop();
 	void InvalidateSession(websocketpp::connection_hdl hdl);
 	void BroadcastEvent(uint64_t requiredIntent, const std::string &eventType, const json &eventData = nullptr,
-			    uint8_t rpcVersion = 0);
+			    uint8_t rpcVersion = 0, const Utils::Json::RawFields &rawFields = {});
+	// Sends an event to a single session, regardless of its event subscriptions
+	void SendEvent(SessionPtr session, const std::string &eventType, json eventData);
 	inline void SetObsReady(bool ready) { _obsReady = ready; }
 	inline bool IsListening() { return _server.is_listening(); }
 	std::vector<WebSocketSessionState> GetWebSocketSessions();
@@ -75,6 +77,10 @@ private:
 		WebSocketCloseCode::WebSocketCloseCode closeCode = WebSocketCloseCode::DontClose;
 		std::string closeReason;
 		json result;
+		std::vector<json> additionalResults; // Sent after `result`, each as its own message
+		Utils::Json::RawFields rawFields;    // Written into the results when they are encoded
+		// Sent after all other results as binary messages (Json sessions only)
+		std::vector<std::vector<uint8_t>> binaryResults;
 	};
 
 	void ServerRunner();
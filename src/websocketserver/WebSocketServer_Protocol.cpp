@@ -17,6 +17,7 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
 #include <obs-module.h>
 #include <util/profiler.hpp>
 
@@ -34,26 +35,78 @@ static bool IsSupportedRpcVersion(uint8_t requestedVersion)
 	return (requestedVersion == CURRENT_RPC_VERSION);
 }
 
-static json ConstructRequestResult(RequestResult requestResult, const json &requestJson)
+// Splits the largest array in `responseData` over several messages, so that each is encoded and sent on its own.
+// This bounds the size of every frame, but not peak memory, as the full response has already been built.
+static std::vector<json> ChunkRequestResponse(json &&resultPayloadData, size_t chunkSize)
 {
-	json ret;
+	std::string chunkKey;
+	size_t chunkKeySize = 0;
+	// Error responses have no `responseData`, which must not be added to them
+	auto responseData = resultPayloadData.find("responseData");
+	if (responseData != resultPayloadData.end() && responseData->is_object()) {
+		for (auto &[key, value] : responseData->items()) {
+			if (value.is_array() && value.size() > chunkKeySize) {
+				chunkKey = key;
+				chunkKeySize = value.size();
+			}
+		}
+	}
 
-	ret["requestType"] = requestJson["requestType"];
+	size_t chunkCount = chunkKeySize ? (chunkKeySize + chunkSize - 1) / chunkSize : 1;
+	resultPayloadData["chunkIndex"] = 0;
+	resultPayloadData["chunkCount"] = chunkCount;
 
-	if (requestJson.contains("requestId") && !requestJson["requestId"].is_null())
-		ret["requestId"] = requestJson["requestId"];
+	std::vector<json> ret;
+	ret.reserve(chunkCount);
+	if (chunkCount == 1) {
+		ret.push_back({{"op", WebSocketOpCode::RequestResponse}, {"d", std::move(resultPayloadData)}});
+		return ret;
+	}
 
-	ret["requestStatus"] = {{"result", requestResult.StatusCode == RequestStatus::Success}, {"code", requestResult.StatusCode}};
+	json::array_t items = std::move((*responseData)[chunkKey].get_ref<json::array_t &>());
+	for (size_t i = 0; i < chunkCount; i++) {
+		auto chunkBegin = items.begin() + i * chunkSize;
+		auto chunkEnd = items.begin() + std::min((i + 1) * chunkSize, items.size());
 
-	if (!requestResult.Comment.empty())
-		ret["requestStatus"]["comment"] = requestResult.Comment;
+		// Only the first chunk contains the other response fields
+		json chunkPayloadData;
+		if (i == 0) {
+			chunkPayloadData = std::move(resultPayloadData);
+		} else {
+			chunkPayloadData["requestType"] = ret[0]["d"]["requestType"];
+			chunkPayloadData["requestId"] = ret[0]["d"]["requestId"];
+			chunkPayloadData["requestStatus"] = ret[0]["d"]["requestStatus"];
+			chunkPayloadData["chunkIndex"] = i;
+			chunkPayloadData["chunkCount"] = chunkCount;
+		}
+		chunkPayloadData["responseData"][chunkKey] =
+			json::array_t(std::make_move_iterator(chunkBegin), std::make_move_iterator(chunkEnd));
 
-	if (requestResult.ResponseData.is_object())
-		ret["responseData"] = requestResult.ResponseData;
+		ret.push_back({{"op", WebSocketOpCode::RequestResponse}, {"d", std::move(chunkPayloadData)}});
+	}
 
 	return ret;
 }
 
+// Json has no binary type, so binary response/event fields are sent to Json sessions as binary messages following
+// the message. Each field is replaced by its size in bytes, and the messages are sent in the order the fields are
+// serialized in. Nested objects and arrays are included, like the `results` of `CallRequestBatchTemplate`.
+static void MoveBinaryFields(json &data, std::vector<std::vector<uint8_t>> &binaryResults)
+{
+	if (data.is_binary()) {
+		// The buffer is moved rather than copied, as it usually holds a whole encoded image
+		binaryResults.push_back(std::move(data.get_binary()));
+		data = binaryResults.back().size();
+		return;
+	}
+
+	if (!data.is_structured())
+		return;
+
+	for (auto &value : data)
+		MoveBinaryFields(value, binaryResults);
+}
+
 void WebSocketServer::SetSessionParameters(SessionPtr session, ProcessResult &ret, const json &payloadData)
 {
 	if (payloadData.contains("eventSubscriptions")) {
@@ -207,11 +260,31 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 			return;
 		}
 
+		size_t responseChunkSize = 0;
+		if (payloadData.contains("responseChunkSize") && !payloadData["responseChunkSize"].is_null()) {
+			if (!payloadData["responseChunkSize"].is_number_unsigned()) {
+				ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
+				ret.closeReason = "Your `responseChunkSize` is not a positive number.";
+				return;
+			}
+
+			responseChunkSize = payloadData["responseChunkSize"];
+			if (!responseChunkSize) {
+				ret.closeCode = WebSocketCloseCode::InvalidDataFieldValue;
+				ret.closeReason = "Your `responseChunkSize` must be at least 1.";
+				return;
+			}
+		}
+
 		std::string requestType = payloadData["requestType"];
 		RequestResult requestResult;
 		if (_obsReady) {
-			json requestData = payloadData["requestData"];
-			Request request(requestType, requestData);
+			Request request(requestType, std::move(payloadData["requestData"]));
+			// The response is only encoded in the session's encoding, so the raw fields are too
+			if (session->Encoding() == WebSocketEncoding::Json)
+				request.RawFieldEncodings = Utils::Json::RawFields::EncodeJson;
+			else
+				request.RawFieldEncodings = Utils::Json::RawFields::EncodeMsgPack;
 
 			RequestHandler requestHandler(session);
 			requestResult = requestHandler.ProcessRequest(request);
@@ -227,9 +300,22 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 		if (!requestResult.Comment.empty())
 			resultPayloadData["requestStatus"]["comment"] = requestResult.Comment;
 		if (requestResult.ResponseData.is_object())
-			resultPayloadData["responseData"] = requestResult.ResponseData;
+			resultPayloadData["responseData"] = std::move(requestResult.ResponseData);
+		ret.rawFields = std::move(requestResult.ResponseRawFields);
+
+		if (session->Encoding() == WebSocketEncoding::Json && resultPayloadData.contains("responseData"))
+			MoveBinaryFields(resultPayloadData["responseData"], ret.binaryResults);
+
+		if (responseChunkSize) {
+			std::vector<json> chunks = ChunkRequestResponse(std::move(resultPayloadData), responseChunkSize);
+			ret.result = std::move(chunks[0]);
+			ret.additionalResults.assign(std::make_move_iterator(chunks.begin() + 1),
+						     std::make_move_iterator(chunks.end()));
+			return;
+		}
+
 		ret.result["op"] = WebSocketOpCode::RequestResponse;
-		ret.result["d"] = resultPayloadData;
+		ret.result["d"] = std::move(resultPayloadData);
 	}
 		return;
 	case WebSocketOpCode::RequestBatch: { // RequestBatch
@@ -292,6 +378,24 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 			haltOnFailure = payloadData["haltOnFailure"];
 		}
 
+		bool atomic = false;
+		if (payloadData.contains("atomic") && !payloadData["atomic"].is_null()) {
+			if (!payloadData["atomic"].is_boolean()) {
+				ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
+				ret.closeReason = "Your `atomic` is not a boolean.";
+				return;
+			}
+
+			atomic = payloadData["atomic"];
+
+			// Only SerialFrame batches can be processed within a single graphics tick
+			if (atomic && executionType != RequestBatchExecutionType::SerialFrame) {
+				ret.closeCode = WebSocketCloseCode::UnsupportedFeature;
+				ret.closeReason = "Atomic request batches are only supported in SerialFrame mode.";
+				return;
+			}
+		}
+
 		if (!payloadData.contains("requests")) {
 			ret.closeCode = WebSocketCloseCode::MissingDataField;
 			ret.closeReason = "Your payload data is missing a `requests`.";
@@ -304,24 +408,26 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 			return;
 		}
 
-		std::vector<json> requests = payloadData["requests"];
+		// The request array is used in place. Only `requestType` and `requestId` are needed again when building
+		// the results, so the potentially large data fields are moved out of it instead of being copied.
+		json &requests = payloadData["requests"];
 		std::vector<RequestResult> resultsVector;
 		if (_obsReady) {
 			std::vector<RequestBatchRequest> requestsVector;
+			requestsVector.reserve(requests.size());
 			for (auto &requestJson : requests) {
 				if (!requestJson["requestType"].is_string())
 					requestJson["requestType"] =
 						""; // Workaround for what would otherwise be extensive additional logic for a rare edge case
-				std::string requestType = requestJson["requestType"];
-				json requestData = requestJson["requestData"];
-				json inputVariables = requestJson["inputVariables"];
-				json outputVariables = requestJson["outputVariables"];
-				requestsVector.emplace_back(requestType, requestData, executionType, inputVariables,
-							    outputVariables);
+				requestsVector.emplace_back(requestJson["requestType"].get_ref<const std::string &>(),
+							    std::move(requestJson["requestData"]), executionType,
+							    std::move(requestJson["inputVariables"]),
+							    std::move(requestJson["outputVariables"]),
+							    std::move(requestJson["condition"]), std::move(requestJson["repeat"]));
 			}
 
 			resultsVector = RequestBatchHandler::ProcessRequestBatch(
-				_threadPool, session, executionType, requestsVector, payloadData["variables"], haltOnFailure);
+				_threadPool, session, executionType, requestsVector, payloadData["variables"], haltOnFailure, atomic);
 		} else {
 			// I lowkey hate this, but whatever
 			if (haltOnFailure) {
@@ -333,16 +439,22 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 			}
 		}
 
+		bool moveBinaryFields = session->Encoding() == WebSocketEncoding::Json;
 		size_t i = 0;
-		std::vector<json> results;
+		json results = json::array();
 		for (auto &requestResult : resultsVector) {
-			results.push_back(ConstructRequestResult(requestResult, requests[i]));
+			const json &requestJson = requests[i];
+			json requestId = requestJson.contains("requestId") ? requestJson["requestId"] : json();
+			results.push_back(
+				RequestBatchHandler::GetResultJson(std::move(requestResult), requestJson["requestType"], requestId));
+			if (moveBinaryFields && results.back().contains("responseData"))
+				MoveBinaryFields(results.back()["responseData"], ret.binaryResults);
 			i++;
 		}
 
 		ret.result["op"] = WebSocketOpCode::RequestBatchResponse;
 		ret.result["d"]["requestId"] = payloadData["requestId"];
-		ret.result["d"]["results"] = results;
+		ret.result["d"]["results"] = std::move(results);
 	}
 		return;
 	default:
@@ -354,12 +466,13 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 
 // It isn't consistent to directly call the WebSocketServer from the events system, but it would also be dumb to make it unnecessarily complicated.
 void WebSocketServer::BroadcastEvent(uint64_t requiredIntent, const std::string &eventType, const json &eventData,
-				     uint8_t rpcVersion)
+				     uint8_t rpcVersion, const Utils::Json::RawFields &rawFields)
 {
 	if (!_server.is_listening() || !_obsReady)
 		return;
 
-	_threadPool.start(Utils::Compat::CreateFunctionRunnable([eventType, requiredIntent, eventData, rpcVersion, this]() {
+	_threadPool.start(Utils::Compat::CreateFunctionRunnable([eventType, requiredIntent, eventData, rpcVersion, rawFields,
+								 this]() {
 		// Populate message object
 		json eventMessage;
 		eventMessage["op"] = 5;
@@ -384,14 +497,14 @@ void WebSocketServer::BroadcastEvent(uint64_t requiredIntent, const std::string
 				switch (it.second->Encoding()) {
 				case WebSocketEncoding::Json:
 					if (messageJson.empty())
-						messageJson = eventMessage.dump();
+						messageJson = rawFields.Dump(eventMessage);
 					_server.send((websocketpp::connection_hdl)it.first, messageJson,
 						     websocketpp::frame::opcode::text, errorCode);
 					it.second->IncrementOutgoingMessages();
 					break;
 				case WebSocketEncoding::MsgPack:
 					if (messageMsgPack.empty()) {
-						auto msgPackData = json::to_msgpack(eventMessage);
+						auto msgPackData = rawFields.ToMsgPack(eventMessage);
 						messageMsgPack = std::string(msgPackData.begin(), msgPackData.end());
 					}
 					_server.send((websocketpp::connection_hdl)it.first, messageMsgPack,
@@ -406,6 +519,56 @@ void WebSocketServer::BroadcastEvent(uint64_t requiredIntent, const std::string
 		}
 		lock.unlock();
 		if (IsDebugEnabled() && (EventSubscription::All & requiredIntent) != 0) // Don't log high volume events
-			blog(LOG_INFO, "[WebSocketServer::BroadcastEvent] Outgoing event:\n%s", eventMessage.dump(2).c_str());
+			blog(LOG_INFO, "[WebSocketServer::BroadcastEvent] Outgoing event:\n%s",
+			     rawFields.Expand(eventMessage).dump(2).c_str());
 	}));
 }
+
+void WebSocketServer::SendEvent(SessionPtr session, const std::string &eventType, json eventData)
+{
+	if (!_server.is_listening() || !_obsReady)
+		return;
+
+	json eventMessage;
+	eventMessage["op"] = WebSocketOpCode::Event;
+	eventMessage["d"]["eventType"] = eventType;
+	eventMessage["d"]["eventIntent"] = EventSubscription::None;
+
+	std::vector<std::vector<uint8_t>> binaryResults;
+	if (session->Encoding() == WebSocketEncoding::Json)
+		MoveBinaryFields(eventData, binaryResults);
+	if (eventData.is_object())
+		eventMessage["d"]["eventData"] = std::move(eventData);
+
+	websocketpp::connection_hdl hdl;
+	{
+		std::lock_guard<std::mutex> lock(_sessionMutex);
+		auto it = std::find_if(_sessions.begin(), _sessions.end(), [&session](auto &it) { return it.second == session; });
+		if (it == _sessions.end())
+			return;
+		hdl = it->first;
+	}
+
+	websocketpp::lib::error_code errorCode;
+	std::unique_lock<std::mutex> sendLock(session->BinaryResultsMutex, std::defer_lock);
+	if (session->Encoding() == WebSocketEncoding::Json) {
+		if (!binaryResults.empty())
+			sendLock.lock();
+		_server.send(hdl, eventMessage.dump(), websocketpp::frame::opcode::text, errorCode);
+	} else {
+		auto msgPackData = json::to_msgpack(eventMessage);
+		std::string messageMsgPack(msgPackData.begin(), msgPackData.end());
+		_server.send(hdl, messageMsgPack, websocketpp::frame::opcode::binary, errorCode);
+	}
+	session->IncrementOutgoingMessages();
+
+	for (auto &binaryResult : binaryResults) {
+		if (errorCode)
+			break;
+		_server.send(hdl, binaryResult.data(), binaryResult.size(), websocketpp::frame::opcode::binary, errorCode);
+		session->IncrementOutgoingMessages();
+	}
+
+	if (errorCode)
+		blog(LOG_ERROR, "[WebSocketServer::SendEvent] Error sending event message: %s", errorCode.message().c_str());
+}
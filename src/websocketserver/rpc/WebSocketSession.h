@@ -23,6 +23,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <string>
 #include <atomic>
 #include <memory>
+#include <map>
 
 #include "../../eventhandler/types/EventSubscription.h"
 #include "plugin-macros.generated.h"
@@ -30,6 +31,9 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 class WebSocketSession;
 typedef std::shared_ptr<WebSocketSession> SessionPtr;
 
+struct RequestBatchTemplate;
+typedef std::shared_ptr<const RequestBatchTemplate> RequestBatchTemplatePtr;
+
 class WebSocketSession {
 public:
 	inline std::string RemoteAddress()
@@ -89,7 +93,28 @@ public:
 	inline uint64_t EventSubscriptions() { return _eventSubscriptions; }
 	inline void SetEventSubscriptions(uint64_t subscriptions) { _eventSubscriptions = subscriptions; }
 
+	inline RequestBatchTemplatePtr GetRequestBatchTemplate(const std::string &templateName)
+	{
+		std::lock_guard<std::mutex> lock(_requestBatchTemplatesMutex);
+		auto it = _requestBatchTemplates.find(templateName);
+		if (it == _requestBatchTemplates.end())
+			return nullptr;
+		return it->second;
+	}
+	inline void SetRequestBatchTemplate(const std::string &templateName, RequestBatchTemplatePtr batchTemplate)
+	{
+		std::lock_guard<std::mutex> lock(_requestBatchTemplatesMutex);
+		_requestBatchTemplates[templateName] = batchTemplate;
+	}
+	inline bool RemoveRequestBatchTemplate(const std::string &templateName)
+	{
+		std::lock_guard<std::mutex> lock(_requestBatchTemplatesMutex);
+		return _requestBatchTemplates.erase(templateName) > 0;
+	}
+
 	std::mutex OperationMutex;
+	// Held while sending a response followed by binary messages
+	std::mutex BinaryResultsMutex;
 
 private:
 	std::mutex _remoteAddressMutex;
@@ -106,4 +131,6 @@ private:
 	std::atomic<uint8_t> _rpcVersion = OBS_WEBSOCKET_RPC_VERSION;
 	std::atomic<bool> _isIdentified = false;
 	std::atomic<uint64_t> _eventSubscriptions = EventSubscription::All;
+	std::mutex _requestBatchTemplatesMutex;
+	std::map<std::string, RequestBatchTemplatePtr> _requestBatchTemplates;
 };